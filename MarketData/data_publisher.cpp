@@ -1,3 +1,5 @@
+#pragma once
+
 #include <string>
 #include <vector>
 #include <librdkafka/rdkafkacpp.h>
@@ -12,10 +14,17 @@ private:
 
     RdKafka::Conf* conf;
     RdKafka::Producer* producer;
+    int32_t partitionCount;
     Profiler& profiler;
 public:
-    KafkaPublisher(Profiler& profiler)
-        : profiler(profiler) {
+    /**
+     * @param profiler The profiler object to be used for performance measurement.
+     * @param partitionCount When non-zero, messages are routed to partition
+     *        symbolPartition(ticker, partitionCount) so each consumer shard owns a fixed set of
+     *        symbols; zero leaves partitioning to Kafka.
+     */
+    KafkaPublisher(Profiler& profiler, int32_t partitionCount = 0)
+        : partitionCount(partitionCount), profiler(profiler) {
         profiler.startComponent("Data Publisher");
         conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
         conf->set("bootstrap.servers", brokerAddr, errstr);
@@ -45,12 +54,36 @@ public:
         profiler.stopComponent("Data Publisher");
     }
     
+    /**
+     * Publishes the end-of-day marker for a trading day and waits for delivery, so the
+     * consumer can tell the end of a day apart from a gap in the feed.
+     * @param date The trading day that was just published.
+     */
+    void publishEndOfDay(const std::string& date) {
+        profiler.startComponent("Data Publisher");
+        if (partitionCount > 0) {
+            for (int32_t partition = 0; partition < partitionCount; partition++)
+                produce(partition, 0, endOfDayKey, date);
+        } else {
+            publishMessage(0, endOfDayKey, date);
+        }
+        producer->flush(1000);
+        profiler.stopComponent("Data Publisher");
+    }
+
     void publish_from_file(){
         publish(read(interpolatedFile));
     }
 
     bool publishMessage(int64_t timestamp, const std::string& key, const std::string& value) {
-        RdKafka::ErrorCode err = producer->produce(topicName, RdKafka::Topic::PARTITION_UA,
+        int32_t partition = partitionCount > 0
+            ? static_cast<int32_t>(symbolPartition(key, static_cast<uint32_t>(partitionCount)))
+            : RdKafka::Topic::PARTITION_UA;
+        return produce(partition, timestamp, key, value);
+    }
+
+    bool produce(int32_t partition, int64_t timestamp, const std::string& key, const std::string& value) {
+        RdKafka::ErrorCode err = producer->produce(topicName, partition,
                                                     RdKafka::Producer::RK_MSG_COPY,
                                                     const_cast<char*>(value.c_str()), value.size(),
                                                     const_cast<char*>(key.c_str()), key.size(),
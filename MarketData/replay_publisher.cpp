@@ -0,0 +1,152 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cerrno>
+#include <time.h>
+#include <sys/prctl.h>
+
+#include "../Profiler/performance_profiler.h"
+#include "../Profiler/latency_histogram.h"
+#include "../Model/stock_price.h"
+#include "../Pipeline/wait_strategy.h"
+#include "data_publisher.cpp"
+
+/**
+ * Pacing and load-shaping options of the ReplayPublisher.
+ */
+struct ReplayConfig {
+    double speed = 0.0;               // Replay speed factor (1x, 10x, 100x...); 0 publishes as fast as possible
+    int64_t spinThresholdNs = 200000; // Sleep until this close to a deadline, then busy-poll the rest
+    int64_t jitterNs = 0;             // Uniform +/- jitter added to every tick's deadline
+    double burstProbability = 0.0;    // Chance that a tick starts a burst
+    size_t burstSize = 0;             // Ticks released together at the deadline of the tick starting the burst
+    uint64_t seed = 42;               // Seed of the jitter and burst generator
+};
+
+/**
+ * Outcome of one replay: achieved versus target rate and how late ticks left.
+ */
+struct ReplayReport {
+    size_t ticks = 0;
+    double elapsedSeconds = 0.0;
+    double targetRate = 0.0;   // Ticks per second implied by the event timestamps and speed factor
+    double achievedRate = 0.0; // Ticks per second actually published
+    LatencyHistogram schedulingError; // Send time minus deadline, in nanoseconds
+
+    void print() const {
+        std::cout << "Replay: " << ticks << " ticks in " << elapsedSeconds << " seconds, target rate "
+                  << targetRate << "/s, achieved rate " << achievedRate << "/s" << std::endl;
+        std::cout << "Replay scheduling error (ns): p50=" << schedulingError.percentile(50)
+                  << " p99=" << schedulingError.percentile(99)
+                  << " p99.9=" << schedulingError.percentile(99.9)
+                  << " max=" << schedulingError.max() << std::endl;
+    }
+};
+
+/**
+ * Publishes interpolated ticks on the cadence of their event timestamps, so the consumer sees the
+ * 10ms spacing and bursts it would see live instead of a whole day dumped onto the topic at once.
+ *
+ * Each tick is released at (eventTime - firstEventTime) / speed after the replay starts. The wait is
+ * a hybrid: clock_nanosleep on an absolute CLOCK_MONOTONIC deadline until spinThresholdNs before the
+ * deadline, then a busy-poll for the remainder, which keeps scheduling error in the microseconds
+ * without burning a core during long gaps.
+ */
+class ReplayPublisher {
+private:
+    KafkaPublisher& publisher;
+    ReplayConfig config;
+    Profiler& profiler;
+
+    static int64_t monotonicNanoseconds() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    void waitUntil(int64_t deadlineNs) const {
+        int64_t sleepUntil = deadlineNs - config.spinThresholdNs;
+        if (sleepUntil > monotonicNanoseconds()) {
+            timespec ts;
+            ts.tv_sec = sleepUntil / 1000000000LL;
+            ts.tv_nsec = sleepUntil % 1000000000LL;
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+        }
+        while (monotonicNanoseconds() < deadlineNs)
+            cpuRelax();
+    }
+
+public:
+    ReplayPublisher(KafkaPublisher& publisher, const ReplayConfig& config, Profiler& profiler)
+        : publisher(publisher), config(config), profiler(profiler) {}
+
+    /**
+     * Replays the ticks, which must be sorted by event time (milliseconds since midnight).
+     * @param prices The interpolated ticks of one trading day.
+     * @return The achieved rate and the scheduling error distribution of this replay.
+     */
+    ReplayReport replay(const std::vector<StockPrice>& prices) {
+        ReplayReport report;
+        if (prices.empty())
+            return report;
+
+        profiler.startComponent("Replay Publisher");
+        // The default 50us timer slack would let clock_nanosleep overshoot into the spin window.
+        prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+        LatencyHistogram& profiledError = profiler.latencyHistogram("Replay Scheduling Error");
+
+        std::mt19937_64 rng(config.seed);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::uniform_int_distribution<int64_t> jitter(-config.jitterNs, config.jitterNs);
+
+        const int64_t firstEventMs = std::stoll(prices.front().time);
+        const int64_t lastEventMs = std::stoll(prices.back().time);
+        const bool paced = config.speed > 0.0;
+        const double nsPerEventMs = paced ? 1e6 / config.speed : 0.0;
+
+        const int64_t start = monotonicNanoseconds();
+        int64_t burstDeadline = 0;
+        size_t burstRemaining = 0;
+
+        for (const StockPrice& price : prices) {
+            const int64_t eventMs = std::stoll(price.time);
+
+            int64_t deadline = start;
+            if (paced) {
+                if (burstRemaining > 0) {
+                    deadline = burstDeadline;
+                    --burstRemaining;
+                } else {
+                    deadline = start + static_cast<int64_t>((eventMs - firstEventMs) * nsPerEventMs);
+                    if (config.jitterNs > 0)
+                        deadline += jitter(rng);
+                    if (config.burstSize > 0 && unit(rng) < config.burstProbability) {
+                        burstDeadline = deadline;
+                        burstRemaining = config.burstSize - 1;
+                    }
+                }
+                waitUntil(deadline);
+            }
+
+            int64_t sent = monotonicNanoseconds();
+            publisher.publishMessage(eventMs, price.ticker, std::to_string(price.price));
+
+            if (paced) {
+                uint64_t error = sent > deadline ? static_cast<uint64_t>(sent - deadline) : 0;
+                report.schedulingError.record(error);
+                profiledError.record(error);
+            }
+        }
+
+        report.ticks = prices.size();
+        report.elapsedSeconds = (monotonicNanoseconds() - start) / 1e9;
+        report.achievedRate = report.elapsedSeconds > 0.0 ? report.ticks / report.elapsedSeconds : 0.0;
+        double targetSeconds = paced ? (lastEventMs - firstEventMs) * nsPerEventMs / 1e9 : 0.0;
+        report.targetRate = targetSeconds > 0.0 ? report.ticks / targetSeconds : 0.0;
+
+        profiler.stopComponent("Replay Publisher");
+        return report;
+    }
+};
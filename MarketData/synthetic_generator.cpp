@@ -0,0 +1,318 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+
+#include "../Profiler/performance_profiler.h"
+#include "../Model/stock_price.h"
+#include "../Model/util.h"
+
+/**
+ * Parameters of the synthetic market. Returns follow a one-factor correlated geometric Brownian
+ * motion: every symbol loads on a common market shock with weight marketBeta, so the pairwise
+ * correlation of minute returns is marketBeta^2. A market-wide two-state regime scales volatility,
+ * and each symbol experiences Poisson jumps in log price.
+ */
+struct SyntheticMarketConfig {
+    size_t symbolCount = 500;
+    std::string startDate = "2023-08-01";   // First trading day; weekends are skipped
+    size_t tradingDays = 5;
+    uint64_t seed = 7;
+
+    double annualDrift = 0.05;
+    double annualVolatility = 0.25;
+    double marketBeta = 0.6;
+    double volatileRegimeMultiplier = 2.5;  // Volatility scale while the market is in the volatile regime
+    double regimeEnterProbability = 0.002;  // Per-minute chance of entering the volatile regime
+    double regimeExitProbability = 0.02;    // Per-minute chance of leaving it
+    double jumpsPerDay = 0.2;
+    double jumpMean = 0.0;                  // Mean jump in log price
+    double jumpStdDev = 0.02;               // Jump size standard deviation in log price
+    double initialPriceMin = 20.0;
+    double initialPriceMax = 500.0;
+
+    size_t threads = 0;                     // 0 uses every hardware thread
+};
+
+/**
+ * xoshiro256++ seeded through splitmix64. Small and fast enough that the generator is bounded by
+ * arithmetic rather than the random source, and usable with the <random> distributions.
+ */
+struct Xoshiro256 {
+    using result_type = uint64_t;
+    uint64_t s[4];
+
+    explicit Xoshiro256(uint64_t seed) {
+        for (uint64_t& word : s) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+
+    uint64_t operator()() {
+        uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+/**
+ * Deterministic, seed-driven minute bars for a synthetic universe of symbols.
+ *
+ * Prices are stored per symbol as one contiguous row of tradingDays * barsPerDay opening prices,
+ * so worker threads generate disjoint rows without sharing anything but the precomputed market
+ * factor path. Every symbol draws from its own generator derived from (seed, symbol index), so the
+ * output does not depend on the number of threads.
+ */
+class SyntheticMarketData {
+public:
+    static constexpr size_t barsPerDay = 390; // 09:30 to 16:00, one bar per minute
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    SyntheticMarketConfig config;
+    std::vector<std::string> symbolNames;
+    std::vector<std::string> dates;
+    std::vector<double> marketShocks;     // Common standard normal shock per minute
+    std::vector<double> volatilityScale;  // Regime volatility multiplier per minute
+    std::vector<double> prices;           // [symbol][day * barsPerDay + minute]
+
+    static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+
+    static std::string civilFromDays(int64_t z) {
+        z += 719468;
+        const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+        const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+        const int64_t y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+        char buffer[48];
+        std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u", static_cast<long long>(y), m, d);
+        return buffer;
+    }
+
+    static std::string minuteTime(const std::string& date, size_t minute) {
+        size_t minutesSinceMidnight = 9 * 60 + 30 + minute;
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%s %02zu:%02zu:00", date.c_str(),
+                      minutesSinceMidnight / 60, minutesSinceMidnight % 60);
+        return buffer;
+    }
+
+    void buildCalendar() {
+        int year = 0, month = 0, day = 0;
+        std::sscanf(config.startDate.c_str(), "%d-%d-%d", &year, &month, &day);
+        int64_t current = daysFromCivil(year, month, day);
+        while (dates.size() < config.tradingDays) {
+            // 1970-01-01 was a Thursday; weekday 0 is Monday.
+            int64_t weekday = ((current % 7) + 7 + 3) % 7;
+            if (weekday < 5)
+                dates.push_back(civilFromDays(current));
+            ++current;
+        }
+    }
+
+    void buildMarketFactor() {
+        const size_t minutes = dates.size() * barsPerDay;
+        marketShocks.resize(minutes);
+        volatilityScale.resize(minutes);
+
+        Xoshiro256 rng(config.seed);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        bool volatile_ = false;
+        for (size_t t = 0; t < minutes; t++) {
+            double u = unit(rng);
+            volatile_ = volatile_ ? u >= config.regimeExitProbability : u < config.regimeEnterProbability;
+            volatilityScale[t] = volatile_ ? config.volatileRegimeMultiplier : 1.0;
+            marketShocks[t] = normal(rng);
+        }
+    }
+
+    void generateSymbols(size_t first, size_t last) {
+        const size_t minutes = dates.size() * barsPerDay;
+        const double dt = 1.0 / (252.0 * barsPerDay);
+        const double sigma = config.annualVolatility * std::sqrt(dt);
+        const double drift = (config.annualDrift - 0.5 * config.annualVolatility * config.annualVolatility) * dt;
+        const double idiosyncraticWeight = std::sqrt(std::max(0.0, 1.0 - config.marketBeta * config.marketBeta));
+        const double jumpProbability = config.jumpsPerDay / barsPerDay;
+
+        for (size_t symbol = first; symbol < last; symbol++) {
+            Xoshiro256 rng(config.seed ^ (0xd1b54a32d192ed03ULL * (symbol + 1)));
+            std::normal_distribution<double> normal(0.0, 1.0);
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+            double* row = &prices[symbol * minutes];
+            double logPrice = std::log(config.initialPriceMin +
+                                       unit(rng) * (config.initialPriceMax - config.initialPriceMin));
+            for (size_t t = 0; t < minutes; t++) {
+                row[t] = std::exp(logPrice);
+                double shock = config.marketBeta * marketShocks[t] + idiosyncraticWeight * normal(rng);
+                logPrice += drift + sigma * volatilityScale[t] * shock;
+                if (unit(rng) < jumpProbability)
+                    logPrice += config.jumpMean + config.jumpStdDev * normal(rng);
+            }
+        }
+    }
+
+public:
+    SyntheticMarketData(const SyntheticMarketConfig& config)
+        : config(config) {
+        char buffer[32];
+        for (size_t i = 0; i < config.symbolCount; i++) {
+            std::snprintf(buffer, sizeof(buffer), "SYN%05zu", i);
+            symbolNames.push_back(buffer);
+        }
+        buildCalendar();
+    }
+
+    /**
+     * Generates every bar of every symbol, splitting the universe across worker threads.
+     * @param profiler Profiler to measure performance.
+     */
+    void generate(Profiler& profiler) {
+        profiler.startComponent("Synthetic Generator");
+        auto start = std::chrono::steady_clock::now();
+
+        buildMarketFactor();
+        prices.assign(symbolNames.size() * dates.size() * barsPerDay, 0.0);
+
+        size_t threadCount = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, std::max<size_t>(symbolNames.size(), 1));
+        size_t chunk = (symbolNames.size() + threadCount - 1) / threadCount;
+
+        std::vector<std::thread> threads;
+        for (size_t first = 0; first < symbolNames.size(); first += chunk)
+            threads.emplace_back(&SyntheticMarketData::generateSymbols, this, first,
+                                 std::min(first + chunk, symbolNames.size()));
+        for (auto& thread : threads)
+            thread.join();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Generated " << prices.size() << " bars for " << symbolNames.size() << " symbols over "
+                  << dates.size() << " days in " << seconds << " seconds ("
+                  << (seconds > 0.0 ? prices.size() / seconds * 60.0 : 0.0) << " bars/minute)" << std::endl;
+        profiler.stopComponent("Synthetic Generator");
+    }
+
+    const std::vector<std::string>& symbols() const { return symbolNames; }
+    const std::vector<std::string>& tradingDates() const { return dates; }
+
+    /**
+     * @return The index of a trading date, or npos if it is not part of the generated range.
+     */
+    size_t dayIndex(const std::string& date) const {
+        auto it = std::find(dates.begin(), dates.end(), date);
+        return it == dates.end() ? npos : static_cast<size_t>(it - dates.begin());
+    }
+
+    double price(size_t symbol, size_t day, size_t minute) const {
+        return prices[symbol * dates.size() * barsPerDay + day * barsPerDay + minute];
+    }
+
+    /**
+     * Returns one day of bars in the layout parseDay produces: every symbol's minutes in order,
+     * symbols concatenated, ready to be handed to the interpolator.
+     * @param day The index of the trading day.
+     */
+    std::vector<StockPrice> dayPrices(size_t day) const {
+        std::vector<StockPrice> result;
+        result.reserve(symbolNames.size() * barsPerDay);
+        std::vector<std::string> times;
+        for (size_t minute = 0; minute < barsPerDay; minute++)
+            times.push_back(minuteTime(dates[day], minute));
+
+        for (size_t symbol = 0; symbol < symbolNames.size(); symbol++) {
+            for (size_t minute = 0; minute < barsPerDay; minute++)
+                result.emplace_back(symbolNames[symbol], times[minute], price(symbol, day, minute));
+        }
+        return result;
+    }
+
+    /**
+     * Writes every bar in the "exchange_prices.csv" layout produced by the web scraper.
+     * @param destination The path of the CSV file to write.
+     */
+    void writeCsv(const std::string& destination = exchangeFile) const {
+        std::ofstream outputFile(destination);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error opening the file: " << destination << std::endl;
+            return;
+        }
+
+        outputFile << "ticker,date,price\n";
+        char buffer[96];
+        for (size_t day = 0; day < dates.size(); day++) {
+            for (size_t symbol = 0; symbol < symbolNames.size(); symbol++) {
+                for (size_t minute = 0; minute < barsPerDay; minute++) {
+                    int length = std::snprintf(buffer, sizeof(buffer), "%s,%s,%.4f\n", symbolNames[symbol].c_str(),
+                                               minuteTime(dates[day], minute).c_str(), price(symbol, day, minute));
+                    outputFile.write(buffer, length);
+                }
+            }
+        }
+    }
+
+    /**
+     * Writes every bar in a compact binary layout: the magic "LLTFSYN1", the symbol, day and bar
+     * counts as uint64, each symbol and date as a uint32 length followed by its characters, and
+     * then the prices as doubles in [symbol][day][minute] order.
+     * @param destination The path of the binary file to write.
+     */
+    void writeBinary(const std::string& destination) const {
+        std::ofstream outputFile(destination, std::ios::binary);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error opening the file: " << destination << std::endl;
+            return;
+        }
+
+        auto writeU64 = [&](uint64_t value) { outputFile.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+        auto writeString = [&](const std::string& value) {
+            uint32_t length = static_cast<uint32_t>(value.size());
+            outputFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            outputFile.write(value.data(), length);
+        };
+
+        outputFile.write("LLTFSYN1", 8);
+        writeU64(symbolNames.size());
+        writeU64(dates.size());
+        writeU64(barsPerDay);
+        for (const std::string& symbol : symbolNames)
+            writeString(symbol);
+        for (const std::string& date : dates)
+            writeString(date);
+        outputFile.write(reinterpret_cast<const char*>(prices.data()), prices.size() * sizeof(double));
+    }
+};
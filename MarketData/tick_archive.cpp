@@ -0,0 +1,926 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <algorithm>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../Profiler/performance_profiler.h"
+#include "../Model/stock_price.h"
+
+/**
+ * How an archive block stores prices.
+ */
+enum class PriceCodec : uint8_t {
+    FixedPoint = 0, // Deltas of price * 10^priceDecimals, zigzag-encoded and bit-packed per group
+    Xor = 1         // Gorilla-style XOR of consecutive IEEE doubles; lossless
+};
+
+/**
+ * How the tick timestamps of a block were written, so they are reproduced as they came in.
+ */
+enum class TimeFormat : uint8_t {
+    Milliseconds = 0, // Milliseconds since midnight, as produced by the interpolator
+    DateTime = 1      // "yyyy-MM-dd HH:mm:ss", as produced by the web scraper and the synthetic generator
+};
+
+/**
+ * Options of the TickArchiveWriter.
+ */
+struct TickArchiveConfig {
+    PriceCodec priceCodec = PriceCodec::FixedPoint;
+    uint32_t priceDecimals = 6; // Matches the std::to_string precision the publisher sends prices with
+    size_t threads = 0;         // Encoder threads; 0 uses every hardware thread
+};
+
+/**
+ * One entry of the archive index: where the block of one symbol on one day lives.
+ */
+struct TickArchiveEntry {
+    uint32_t symbol;
+    uint32_t day;
+    uint64_t offset;
+    uint32_t count;
+    uint32_t bytes;
+    int64_t firstTime;
+    int64_t lastTime;
+};
+
+/**
+ * Bit-level primitives and the block layout shared by the writer and reader.
+ *
+ * A block holds one symbol's ticks of one day, sorted by time. Its header carries the first
+ * timestamp and price; the remaining values are split into groups of 64. Timestamps are stored
+ * as zigzag-encoded deltas of deltas, which are zero for the interpolator's fixed 10ms cadence.
+ * Fixed-point prices are stored as zigzag-encoded deltas, or deltas of deltas when a group's
+ * prices move linearly, whichever packs narrower; a 1-bit flag records the choice. In both
+ * streams each group starts with a 7-bit width followed by its 64 values packed at that width,
+ * so a group decodes with one width and no per-value branches. XOR prices use the Gorilla bit
+ * stream instead.
+ */
+namespace tick_archive {
+const char kMagic[8] = {'L', 'L', 'T', 'F', 'T', 'A', 'R', '1'};
+const uint32_t kVersion = 1;
+const size_t kGroup = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t priceDecimals;
+};
+
+struct FileFooter {
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+struct BlockHeader {
+    uint32_t count;
+    uint8_t priceCodec;
+    uint8_t timeFormat;
+    uint16_t reserved;
+    uint32_t timeWords;
+    uint32_t priceWords;
+    int64_t firstTime;
+    int64_t firstPrice; // Fixed-point value or the raw bits of the double
+};
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline unsigned bitWidth(uint64_t value) {
+    return value ? 64 - __builtin_clzll(value) : 0;
+}
+
+class BitWriter {
+private:
+    std::vector<uint64_t>& words;
+    uint64_t current = 0;
+    unsigned used = 0;
+
+public:
+    explicit BitWriter(std::vector<uint64_t>& words) : words(words) {}
+
+    void write(uint64_t value, unsigned bits) {
+        if (bits == 0)
+            return;
+        current |= value << used;
+        if (used + bits >= 64) {
+            words.push_back(current);
+            current = used ? value >> (64 - used) : 0;
+            used = used + bits - 64;
+        } else {
+            used += bits;
+        }
+    }
+
+    void flush() {
+        if (used)
+            words.push_back(current);
+        // A spare word lets the reader fetch the next word without a bounds check.
+        words.push_back(0);
+        current = 0;
+        used = 0;
+    }
+};
+
+class BitReader {
+private:
+    const uint64_t* words = nullptr;
+    unsigned used = 0;
+
+public:
+    BitReader() = default;
+    explicit BitReader(const uint64_t* words) : words(words) {}
+
+    uint64_t read(unsigned bits) {
+        if (bits == 0)
+            return 0;
+        uint64_t value = *words >> used;
+        if (used + bits >= 64) {
+            ++words;
+            if (used + bits > 64)
+                value |= *words << (64 - used);
+            used = used + bits - 64;
+        } else {
+            used += bits;
+        }
+        return bits == 64 ? value : value & ((1ULL << bits) - 1);
+    }
+};
+
+inline bool parseTime(const std::string& time, int64_t& milliseconds, TimeFormat& format) {
+    int hours, minutes, seconds;
+    if (time.size() > 10 && std::sscanf(time.c_str() + 10, "%d:%d:%d", &hours, &minutes, &seconds) == 3) {
+        milliseconds = (hours * 3600LL + minutes * 60LL + seconds) * 1000LL;
+        format = TimeFormat::DateTime;
+        return true;
+    }
+    char* end = nullptr;
+    milliseconds = std::strtoll(time.c_str(), &end, 10);
+    format = TimeFormat::Milliseconds;
+    return end && *end == '\0' && end != time.c_str();
+}
+
+inline std::string formatTime(int64_t milliseconds, TimeFormat format, const std::string& date) {
+    if (format == TimeFormat::Milliseconds)
+        return std::to_string(milliseconds);
+    const int64_t seconds = milliseconds / 1000;
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%s %02lld:%02lld:%02lld", date.c_str(),
+                  static_cast<long long>(seconds / 3600), static_cast<long long>(seconds / 60 % 60),
+                  static_cast<long long>(seconds % 60));
+    return buffer;
+}
+
+inline unsigned groupWidth(const uint64_t* values, size_t count) {
+    uint64_t combined = 0;
+    for (size_t i = 0; i < count; i++)
+        combined |= values[i];
+    return bitWidth(combined);
+}
+
+/**
+ * Packs the values of one group at the width of the largest.
+ */
+inline void writeGroup(BitWriter& writer, const uint64_t* values, size_t count, unsigned width) {
+    writer.write(width, 7);
+    for (size_t i = 0; i < count; i++)
+        writer.write(values[i], width);
+}
+
+/**
+ * Encodes one symbol's time-sorted ticks into a block: header followed by the time and price words.
+ */
+inline void encodeBlock(const std::vector<int64_t>& times, const std::vector<double>& prices, TimeFormat timeFormat,
+                        PriceCodec codec, double scale, std::vector<uint64_t>& out) {
+    const size_t count = times.size();
+    BlockHeader header{};
+    header.count = static_cast<uint32_t>(count);
+    header.timeFormat = static_cast<uint8_t>(timeFormat);
+    header.firstTime = count ? times[0] : 0;
+
+    // Fixed point only holds prices whose scaled value fits the 53-bit double mantissa.
+    if (codec == PriceCodec::FixedPoint) {
+        for (double price : prices) {
+            if (!std::isfinite(price) || std::fabs(price * scale) >= 9007199254740992.0) {
+                codec = PriceCodec::Xor;
+                break;
+            }
+        }
+    }
+    header.priceCodec = static_cast<uint8_t>(codec);
+
+    std::vector<uint64_t> timeWords;
+    std::vector<uint64_t> priceWords;
+    BitWriter timeWriter(timeWords);
+    BitWriter priceWriter(priceWords);
+    uint64_t timeGroup[kGroup];
+    uint64_t priceGroup[kGroup];
+    uint64_t priceDodGroup[kGroup];
+
+    int64_t previousDelta = 0;
+    int64_t previousPriceDelta = 0;
+    int64_t previousFixed = count ? std::llround(prices[0] * scale) : 0;
+    uint64_t previousBits = 0;
+    if (count)
+        std::memcpy(&previousBits, &prices[0], sizeof(previousBits));
+    header.firstPrice = codec == PriceCodec::FixedPoint ? previousFixed : static_cast<int64_t>(previousBits);
+    unsigned previousLeading = 64;
+    unsigned previousTrailing = 0;
+
+    for (size_t first = 1; first < count; first += kGroup) {
+        const size_t groupSize = std::min(kGroup, count - first);
+        for (size_t j = 0; j < groupSize; j++) {
+            const size_t i = first + j;
+            const int64_t delta = times[i] - times[i - 1];
+            timeGroup[j] = zigzag(delta - previousDelta);
+            previousDelta = delta;
+
+            if (codec == PriceCodec::FixedPoint) {
+                const int64_t fixed = std::llround(prices[i] * scale);
+                const int64_t priceDelta = fixed - previousFixed;
+                priceGroup[j] = zigzag(priceDelta);
+                priceDodGroup[j] = zigzag(priceDelta - previousPriceDelta);
+                previousFixed = fixed;
+                previousPriceDelta = priceDelta;
+            } else {
+                uint64_t bits;
+                std::memcpy(&bits, &prices[i], sizeof(bits));
+                const uint64_t x = bits ^ previousBits;
+                previousBits = bits;
+                if (x == 0) {
+                    priceWriter.write(0, 1);
+                    continue;
+                }
+                const unsigned leading = std::min(__builtin_clzll(x), 31);
+                const unsigned trailing = __builtin_ctzll(x);
+                if (leading >= previousLeading && trailing >= previousTrailing) {
+                    priceWriter.write(1, 2); // '1' then '0': reuse the previous window
+                    priceWriter.write(x >> previousTrailing, 64 - previousLeading - previousTrailing);
+                } else {
+                    const unsigned meaningful = 64 - leading - trailing;
+                    priceWriter.write(3, 2); // '1' then '1': a new window follows
+                    priceWriter.write(leading, 5);
+                    priceWriter.write(meaningful - 1, 6);
+                    priceWriter.write(x >> trailing, meaningful);
+                    previousLeading = leading;
+                    previousTrailing = trailing;
+                }
+            }
+        }
+        writeGroup(timeWriter, timeGroup, groupSize, groupWidth(timeGroup, groupSize));
+        if (codec == PriceCodec::FixedPoint) {
+            const unsigned deltaWidth = groupWidth(priceGroup, groupSize);
+            const unsigned dodWidth = groupWidth(priceDodGroup, groupSize);
+            priceWriter.write(dodWidth < deltaWidth, 1);
+            if (dodWidth < deltaWidth)
+                writeGroup(priceWriter, priceDodGroup, groupSize, dodWidth);
+            else
+                writeGroup(priceWriter, priceGroup, groupSize, deltaWidth);
+        }
+    }
+    timeWriter.flush();
+    priceWriter.flush();
+
+    header.timeWords = static_cast<uint32_t>(timeWords.size());
+    header.priceWords = static_cast<uint32_t>(priceWords.size());
+    const size_t headerWords = sizeof(BlockHeader) / sizeof(uint64_t);
+    out.resize(headerWords);
+    std::memcpy(out.data(), &header, sizeof(header));
+    out.insert(out.end(), timeWords.begin(), timeWords.end());
+    out.insert(out.end(), priceWords.begin(), priceWords.end());
+}
+
+/**
+ * Decodes a block one group of up to 64 ticks at a time, holding no more than one group.
+ */
+class BlockCursor {
+private:
+    BlockHeader header{};
+    BitReader timeReader;
+    BitReader priceReader;
+    double inverseScale = 0.0;
+    uint32_t decoded = 0; // Values produced so far, including the current group
+
+    int64_t previousTime = 0;
+    int64_t previousDelta = 0;
+    int64_t previousPriceDelta = 0;
+    int64_t previousFixed = 0;
+    uint64_t previousBits = 0;
+    unsigned previousLeading = 0;
+    unsigned previousTrailing = 0;
+
+    void decodeXorGroup(size_t groupSize) {
+        for (size_t j = 0; j < groupSize; j++) {
+            if (priceReader.read(1)) {
+                if (priceReader.read(1)) {
+                    previousLeading = static_cast<unsigned>(priceReader.read(5));
+                    const unsigned meaningful = static_cast<unsigned>(priceReader.read(6)) + 1;
+                    previousTrailing = 64 - previousLeading - meaningful;
+                }
+                previousBits ^= priceReader.read(64 - previousLeading - previousTrailing) << previousTrailing;
+            }
+            std::memcpy(&prices[j], &previousBits, sizeof(double));
+        }
+    }
+
+public:
+    int64_t times[kGroup];
+    double prices[kGroup];
+    size_t size = 0;
+
+    BlockCursor() = default;
+
+    BlockCursor(const uint64_t* block, double scale) {
+        std::memcpy(&header, block, sizeof(header));
+        const uint64_t* words = block + sizeof(BlockHeader) / sizeof(uint64_t);
+        timeReader = BitReader(words);
+        priceReader = BitReader(words + header.timeWords);
+        inverseScale = 1.0 / scale;
+        if (header.count == 0)
+            return;
+
+        previousTime = header.firstTime;
+        previousFixed = header.firstPrice;
+        previousBits = static_cast<uint64_t>(header.firstPrice);
+        times[0] = previousTime;
+        if (header.priceCodec == static_cast<uint8_t>(PriceCodec::FixedPoint))
+            prices[0] = static_cast<double>(previousFixed) * inverseScale;
+        else
+            std::memcpy(&prices[0], &previousBits, sizeof(double));
+        size = 1;
+        decoded = 1;
+    }
+
+    TimeFormat timeFormat() const { return static_cast<TimeFormat>(header.timeFormat); }
+
+    /**
+     * Replaces the current group with the next one.
+     * @return False once every tick of the block has been produced.
+     */
+    bool next() {
+        size = std::min<size_t>(kGroup, header.count - decoded);
+        if (size == 0)
+            return false;
+        decoded += static_cast<uint32_t>(size);
+
+        const unsigned timeWidth = static_cast<unsigned>(timeReader.read(7));
+        for (size_t j = 0; j < size; j++) {
+            previousDelta += unzigzag(timeReader.read(timeWidth));
+            previousTime += previousDelta;
+            times[j] = previousTime;
+        }
+
+        if (header.priceCodec == static_cast<uint8_t>(PriceCodec::FixedPoint)) {
+            const bool deltaOfDelta = priceReader.read(1) != 0;
+            const unsigned priceWidth = static_cast<unsigned>(priceReader.read(7));
+            if (deltaOfDelta) {
+                for (size_t j = 0; j < size; j++) {
+                    previousPriceDelta += unzigzag(priceReader.read(priceWidth));
+                    previousFixed += previousPriceDelta;
+                    prices[j] = static_cast<double>(previousFixed) * inverseScale;
+                }
+            } else {
+                for (size_t j = 0; j < size; j++) {
+                    previousPriceDelta = unzigzag(priceReader.read(priceWidth));
+                    previousFixed += previousPriceDelta;
+                    prices[j] = static_cast<double>(previousFixed) * inverseScale;
+                }
+            }
+        } else {
+            decodeXorGroup(size);
+        }
+        return true;
+    }
+};
+}
+
+/**
+ * Writes a compressed, indexed archive of ticks, one block per symbol and day.
+ *
+ * Each day's ticks are grouped by symbol and the blocks are encoded in parallel, then appended
+ * in symbol order. finish() appends the symbol and date tables and the block index, followed by
+ * a footer pointing at them, so the reader can locate any block without scanning.
+ */
+class TickArchiveWriter {
+private:
+    std::string path;
+    TickArchiveConfig config;
+    std::ofstream outputFile;
+    uint64_t offset = 0;
+    std::vector<std::string> symbolNames;
+    std::unordered_map<std::string, uint32_t> symbolIndex;
+    std::vector<std::string> dates;
+    std::vector<TickArchiveEntry> entries;
+
+    void append(const void* data, size_t bytes) {
+        outputFile.write(static_cast<const char*>(data), bytes);
+        offset += bytes;
+    }
+
+    uint32_t symbolFor(const std::string& ticker) {
+        auto it = symbolIndex.find(ticker);
+        if (it != symbolIndex.end())
+            return it->second;
+        uint32_t index = static_cast<uint32_t>(symbolNames.size());
+        symbolIndex.emplace(ticker, index);
+        symbolNames.push_back(ticker);
+        return index;
+    }
+
+public:
+    TickArchiveWriter(const std::string& path, const TickArchiveConfig& config = TickArchiveConfig())
+        : path(path), config(config), outputFile(path, std::ios::binary | std::ios::trunc) {
+        if (!outputFile.is_open()) {
+            std::cerr << "Error opening the file: " << path << std::endl;
+            return;
+        }
+        tick_archive::FileHeader header{};
+        std::memcpy(header.magic, tick_archive::kMagic, sizeof(header.magic));
+        header.version = tick_archive::kVersion;
+        header.priceDecimals = config.priceDecimals;
+        append(&header, sizeof(header));
+    }
+
+    /**
+     * Encodes one trading day. Ticks may arrive in any order; each symbol's block is sorted by time.
+     * @param date The trading date, "yyyy-MM-dd".
+     * @param prices Every tick of the day.
+     */
+    void addDay(const std::string& date, const std::vector<StockPrice>& prices) {
+        if (!outputFile.is_open())
+            return;
+        const uint32_t day = static_cast<uint32_t>(dates.size());
+        dates.push_back(date);
+
+        struct SymbolTicks {
+            uint32_t symbol;
+            std::vector<std::pair<int64_t, double>> ticks;
+            TimeFormat timeFormat = TimeFormat::Milliseconds;
+            std::vector<uint64_t> block;
+        };
+        std::vector<SymbolTicks> groups;
+        std::unordered_map<uint32_t, size_t> groupIndex;
+        size_t unparsable = 0;
+        for (const StockPrice& price : prices) {
+            uint32_t symbol = symbolFor(price.ticker);
+            auto it = groupIndex.find(symbol);
+            if (it == groupIndex.end()) {
+                it = groupIndex.emplace(symbol, groups.size()).first;
+                groups.push_back(SymbolTicks{symbol, {}, TimeFormat::Milliseconds, {}});
+            }
+            int64_t time;
+            TimeFormat format;
+            if (!tick_archive::parseTime(price.time, time, format)) {
+                ++unparsable;
+                continue;
+            }
+            groups[it->second].timeFormat = format;
+            groups[it->second].ticks.emplace_back(time, price.price);
+        }
+        if (unparsable)
+            std::cerr << "Skipped " << unparsable << " ticks with unparsable times on " << date << std::endl;
+        std::sort(groups.begin(), groups.end(),
+                  [](const SymbolTicks& a, const SymbolTicks& b) { return a.symbol < b.symbol; });
+
+        const double scale = std::pow(10.0, config.priceDecimals);
+        auto encodeRange = [&](size_t first, size_t last) {
+            std::vector<int64_t> times;
+            std::vector<double> values;
+            for (size_t g = first; g < last; g++) {
+                SymbolTicks& group = groups[g];
+                std::stable_sort(group.ticks.begin(), group.ticks.end(),
+                                 [](const auto& a, const auto& b) { return a.first < b.first; });
+                times.clear();
+                values.clear();
+                for (const auto& tick : group.ticks) {
+                    times.push_back(tick.first);
+                    values.push_back(tick.second);
+                }
+                tick_archive::encodeBlock(times, values, group.timeFormat, config.priceCodec, scale, group.block);
+            }
+        };
+
+        size_t threadCount = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::min(threadCount, std::max<size_t>(groups.size(), 1));
+        const size_t chunk = (groups.size() + threadCount - 1) / threadCount;
+        std::vector<std::thread> threads;
+        for (size_t first = 0; first < groups.size(); first += chunk)
+            threads.emplace_back(encodeRange, first, std::min(first + chunk, groups.size()));
+        for (auto& thread : threads)
+            thread.join();
+
+        for (SymbolTicks& group : groups) {
+            const size_t bytes = group.block.size() * sizeof(uint64_t);
+            entries.push_back({group.symbol, day, offset, static_cast<uint32_t>(group.ticks.size()),
+                               static_cast<uint32_t>(bytes),
+                               group.ticks.empty() ? 0 : group.ticks.front().first,
+                               group.ticks.empty() ? 0 : group.ticks.back().first});
+            append(group.block.data(), bytes);
+        }
+    }
+
+    /**
+     * Writes the index and footer and closes the file.
+     * @return False if any write failed.
+     */
+    bool finish() {
+        if (!outputFile.is_open())
+            return false;
+        const uint64_t indexOffset = offset;
+        auto writeString = [&](const std::string& value) {
+            uint32_t length = static_cast<uint32_t>(value.size());
+            append(&length, sizeof(length));
+            append(value.data(), length);
+        };
+        uint32_t count = static_cast<uint32_t>(symbolNames.size());
+        append(&count, sizeof(count));
+        for (const std::string& symbol : symbolNames)
+            writeString(symbol);
+        count = static_cast<uint32_t>(dates.size());
+        append(&count, sizeof(count));
+        for (const std::string& date : dates)
+            writeString(date);
+        uint64_t entryCount = entries.size();
+        append(&entryCount, sizeof(entryCount));
+        append(entries.data(), entries.size() * sizeof(TickArchiveEntry));
+
+        tick_archive::FileFooter footer{};
+        footer.indexOffset = indexOffset;
+        std::memcpy(footer.magic, tick_archive::kMagic, sizeof(footer.magic));
+        append(&footer, sizeof(footer));
+        outputFile.close();
+        return !outputFile.fail();
+    }
+
+    uint64_t bytesWritten() const { return offset; }
+};
+
+/**
+ * Memory-maps a tick archive and decodes it block by block.
+ *
+ * decodeBlock() yields a block's timestamps and prices as columns. streamDay() merges every
+ * symbol's block of a day into one time-ordered stream of StockPrice batches, decoding each block
+ * 64 ticks at a time, so a day can be handed to the interpolator or the ReplayPublisher without
+ * materializing it.
+ */
+class TickArchiveReader {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    std::string path;
+    int fd = -1;
+    const char* data = nullptr;
+    size_t size = 0;
+    double scale = 1.0;
+    std::vector<std::string> symbolNames;
+    std::vector<std::string> dates;
+    std::vector<TickArchiveEntry> entries;
+    std::vector<std::vector<size_t>> dayEntries; // Entry indices per day
+
+    const uint64_t* blockAt(const TickArchiveEntry& entry) const {
+        return reinterpret_cast<const uint64_t*>(data + entry.offset);
+    }
+
+    bool parse() {
+        using namespace tick_archive;
+        if (size < sizeof(FileHeader) + sizeof(FileFooter))
+            return false;
+        FileHeader header;
+        FileFooter footer;
+        std::memcpy(&header, data, sizeof(header));
+        std::memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+            || std::memcmp(footer.magic, kMagic, sizeof(kMagic)) != 0 || footer.indexOffset >= size)
+            return false;
+        scale = std::pow(10.0, header.priceDecimals);
+
+        const char* cursor = data + footer.indexOffset;
+        const char* end = data + size - sizeof(footer);
+        auto read = [&](void* out, size_t bytes) {
+            if (static_cast<size_t>(end - cursor) < bytes)
+                return false;
+            std::memcpy(out, cursor, bytes);
+            cursor += bytes;
+            return true;
+        };
+        auto readStrings = [&](std::vector<std::string>& out) {
+            uint32_t count;
+            if (!read(&count, sizeof(count)))
+                return false;
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t length;
+                if (!read(&length, sizeof(length)) || static_cast<size_t>(end - cursor) < length)
+                    return false;
+                out.emplace_back(cursor, length);
+                cursor += length;
+            }
+            return true;
+        };
+        uint64_t entryCount;
+        if (!readStrings(symbolNames) || !readStrings(dates) || !read(&entryCount, sizeof(entryCount))
+            || entryCount > static_cast<size_t>(end - cursor) / sizeof(TickArchiveEntry))
+            return false;
+        entries.resize(entryCount);
+        read(entries.data(), entryCount * sizeof(TickArchiveEntry));
+
+        dayEntries.assign(dates.size(), {});
+        for (size_t i = 0; i < entries.size(); i++) {
+            const TickArchiveEntry& entry = entries[i];
+            if (entry.day >= dates.size() || entry.symbol >= symbolNames.size()
+                || entry.offset + entry.bytes > footer.indexOffset || entry.offset % sizeof(uint64_t) != 0)
+                return false;
+            dayEntries[entry.day].push_back(i);
+        }
+        return true;
+    }
+
+public:
+    TickArchiveReader(const std::string& path) : path(path) {
+        fd = open(path.c_str(), O_RDONLY);
+        struct stat status;
+        if (fd < 0 || fstat(fd, &status) != 0) {
+            std::cerr << "Error opening the file: " << path << std::endl;
+            return;
+        }
+        size = static_cast<size_t>(status.st_size);
+        void* map = size ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        if (map == MAP_FAILED) {
+            std::cerr << "Failed to map tick archive: " << path << std::endl;
+            size = 0;
+            return;
+        }
+        data = static_cast<const char*>(map);
+        madvise(map, size, MADV_SEQUENTIAL);
+        if (!parse()) {
+            std::cerr << "Invalid tick archive: " << path << std::endl;
+            entries.clear();
+            dayEntries.clear();
+            dates.clear();
+        }
+    }
+
+    ~TickArchiveReader() {
+        if (data)
+            munmap(const_cast<char*>(data), size);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    TickArchiveReader(const TickArchiveReader&) = delete;
+    TickArchiveReader& operator=(const TickArchiveReader&) = delete;
+
+    bool valid() const { return !dates.empty(); }
+    const std::vector<std::string>& symbols() const { return symbolNames; }
+    const std::vector<std::string>& tradingDates() const { return dates; }
+    const std::vector<TickArchiveEntry>& index() const { return entries; }
+    size_t bytes() const { return size; }
+
+    /**
+     * @return The index of a trading date, or npos if the archive does not contain it.
+     */
+    size_t dayIndex(const std::string& date) const {
+        auto it = std::find(dates.begin(), dates.end(), date);
+        return it == dates.end() ? npos : static_cast<size_t>(it - dates.begin());
+    }
+
+    /**
+     * @return True if the day holds interpolated ticks rather than minute bars.
+     */
+    bool tickLevel(const std::string& date) const {
+        size_t day = dayIndex(date);
+        if (day == npos || dayEntries[day].empty())
+            return false;
+        tick_archive::BlockCursor cursor(blockAt(entries[dayEntries[day].front()]), scale);
+        return cursor.timeFormat() == TimeFormat::Milliseconds;
+    }
+
+    /**
+     * Decodes one block into columns.
+     * @param entry An entry of index().
+     * @param times[out] Milliseconds since midnight; replaced.
+     * @param prices[out] Prices; replaced.
+     */
+    void decodeBlock(const TickArchiveEntry& entry, std::vector<int64_t>& times, std::vector<double>& prices) const {
+        times.resize(entry.count);
+        prices.resize(entry.count);
+        tick_archive::BlockCursor cursor(blockAt(entry), scale);
+        size_t position = 0;
+        do {
+            std::memcpy(times.data() + position, cursor.times, cursor.size * sizeof(int64_t));
+            std::memcpy(prices.data() + position, cursor.prices, cursor.size * sizeof(double));
+            position += cursor.size;
+        } while (cursor.next());
+    }
+
+    /**
+     * Streams a day's ticks across all symbols in time order; ties keep symbol order.
+     * @param date The trading date.
+     * @param onBatch Called with up to batchSize ticks at a time; the vector is reused between calls.
+     * @param batchSize The largest batch handed to onBatch.
+     * @return The number of ticks streamed.
+     */
+    template <typename Consumer>
+    size_t streamDay(const std::string& date, Consumer&& onBatch, size_t batchSize = 4096) const {
+        size_t day = dayIndex(date);
+        if (day == npos)
+            return 0;
+
+        struct Source {
+            tick_archive::BlockCursor cursor;
+            size_t position;
+            uint32_t symbol;
+        };
+        std::vector<Source> sources;
+        sources.reserve(dayEntries[day].size());
+        for (size_t entryIndex : dayEntries[day]) {
+            const TickArchiveEntry& entry = entries[entryIndex];
+            if (entry.count)
+                sources.push_back({tick_archive::BlockCursor(blockAt(entry), scale), 0, entry.symbol});
+        }
+
+        // Min-heap of (time, source) over the head tick of every block.
+        using Head = std::pair<int64_t, size_t>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        for (size_t s = 0; s < sources.size(); s++)
+            heads.push({sources[s].cursor.times[0], s});
+
+        std::vector<StockPrice> batch;
+        batch.reserve(batchSize);
+        size_t streamed = 0;
+        while (!heads.empty()) {
+            const size_t s = heads.top().second;
+            heads.pop();
+            Source& source = sources[s];
+            tick_archive::BlockCursor& cursor = source.cursor;
+
+            batch.emplace_back(symbolNames[source.symbol],
+                               tick_archive::formatTime(cursor.times[source.position], cursor.timeFormat(), date),
+                               cursor.prices[source.position]);
+            if (batch.size() == batchSize) {
+                streamed += batch.size();
+                onBatch(batch);
+                batch.clear();
+            }
+
+            if (++source.position == cursor.size) {
+                if (!cursor.next())
+                    continue;
+                source.position = 0;
+            }
+            heads.push({cursor.times[source.position], s});
+        }
+        if (!batch.empty()) {
+            streamed += batch.size();
+            onBatch(batch);
+        }
+        return streamed;
+    }
+
+    /**
+     * Decodes a whole day in time order, the layout the interpolator emits and the ReplayPublisher takes.
+     */
+    std::vector<StockPrice> decodeDay(const std::string& date) const {
+        std::vector<StockPrice> prices;
+        streamDay(date, [&](const std::vector<StockPrice>& batch) {
+            prices.insert(prices.end(), batch.begin(), batch.end());
+        });
+        return prices;
+    }
+
+    /**
+     * Decodes a whole day in the layout parseDay produces: every symbol's ticks in time order,
+     * symbols concatenated, ready to be handed to the interpolator.
+     */
+    std::vector<StockPrice> decodeDayBySymbol(const std::string& date) const {
+        std::vector<StockPrice> prices;
+        size_t day = dayIndex(date);
+        if (day == npos)
+            return prices;
+        std::vector<int64_t> times;
+        std::vector<double> values;
+        for (size_t entryIndex : dayEntries[day]) {
+            const TickArchiveEntry& entry = entries[entryIndex];
+            if (entry.count == 0)
+                continue;
+            decodeBlock(entry, times, values);
+            const TimeFormat format = tick_archive::BlockCursor(blockAt(entry), scale).timeFormat();
+            for (size_t i = 0; i < times.size(); i++)
+                prices.emplace_back(symbolNames[entry.symbol], tick_archive::formatTime(times[i], format, date), values[i]);
+        }
+        return prices;
+    }
+};
+
+/**
+ * Archives the given days, then reports the compression against the CSV layout written by
+ * util.cpp's write(), the columnar and streaming decode rates, and the largest decode error.
+ * @param path The archive file to write.
+ * @param dates The trading dates.
+ * @param days The ticks of each date.
+ * @param config The archive options.
+ * @return True if every tick decoded within half a unit of the last stored decimal.
+ */
+inline bool benchmarkTickArchive(const std::string& path, const std::vector<std::string>& dates,
+                                 const std::vector<std::vector<StockPrice>>& days,
+                                 const TickArchiveConfig& config = TickArchiveConfig()) {
+    size_t ticks = 0;
+    size_t csvBytes = 0;
+    char buffer[64];
+    for (const std::vector<StockPrice>& day : days) {
+        ticks += day.size();
+        for (const StockPrice& price : day)
+            csvBytes += price.ticker.size() + price.time.size() + std::snprintf(buffer, sizeof(buffer), "%g", price.price) + 3;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TickArchiveWriter writer(path, config);
+    for (size_t d = 0; d < days.size(); d++)
+        writer.addDay(dates[d], days[d]);
+    bool ok = writer.finish();
+    double encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    TickArchiveReader reader(path);
+    if (!ok || !reader.valid()) {
+        std::cerr << "Failed to write tick archive " << path << std::endl;
+        return false;
+    }
+
+    std::vector<int64_t> times;
+    std::vector<double> prices;
+    start = std::chrono::steady_clock::now();
+    double checksum = 0.0;
+    for (const TickArchiveEntry& entry : reader.index()) {
+        reader.decodeBlock(entry, times, prices);
+        checksum += prices.empty() ? 0.0 : prices.back();
+    }
+    double columnarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    size_t streamed = 0;
+    for (const std::string& date : reader.tradingDates())
+        streamed += reader.streamDay(date, [](const std::vector<StockPrice>&) {});
+    double streamSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Compare every tick with its decoded value, per symbol in time order.
+    double maxError = 0.0;
+    size_t mismatchedTimes = 0;
+    for (size_t d = 0; d < days.size(); d++) {
+        std::unordered_map<std::string, std::vector<std::pair<int64_t, double>>> original;
+        for (const StockPrice& price : days[d]) {
+            int64_t time;
+            TimeFormat format;
+            if (tick_archive::parseTime(price.time, time, format))
+                original[price.ticker].emplace_back(time, price.price);
+        }
+        for (const TickArchiveEntry& entry : reader.index()) {
+            if (entry.day != d)
+                continue;
+            auto& expected = original[reader.symbols()[entry.symbol]];
+            std::stable_sort(expected.begin(), expected.end(),
+                             [](const auto& a, const auto& b) { return a.first < b.first; });
+            reader.decodeBlock(entry, times, prices);
+            for (size_t i = 0; i < times.size() && i < expected.size(); i++) {
+                mismatchedTimes += times[i] != expected[i].first;
+                maxError = std::max(maxError, std::fabs(prices[i] - expected[i].second));
+            }
+        }
+    }
+
+    const double columnarBytes = static_cast<double>(ticks) * (sizeof(int64_t) + sizeof(double));
+    std::cout << "Tick archive: " << ticks << " ticks over " << days.size() << " days, "
+              << reader.index().size() << " blocks" << std::endl;
+    std::cout << "  CSV " << csvBytes << " bytes, archive " << reader.bytes() << " bytes, "
+              << static_cast<double>(csvBytes) / reader.bytes() << "x smaller, "
+              << reader.bytes() * 8.0 / std::max<size_t>(ticks, 1) << " bits/tick" << std::endl;
+    std::cout << "  Encode: " << ticks / encodeSeconds << " ticks/s" << std::endl;
+    std::cout << "  Columnar decode: " << ticks / columnarSeconds << " ticks/s, "
+              << columnarBytes / columnarSeconds / 1e9 << " GB/s decoded, "
+              << csvBytes / columnarSeconds / 1e9 << " GB/s CSV-equivalent (checksum " << checksum << ")" << std::endl;
+    std::cout << "  Streaming decode to StockPrice: " << streamed / streamSeconds << " ticks/s" << std::endl;
+    std::cout << "  Max price error " << maxError << ", mismatched timestamps " << mismatchedTimes << std::endl;
+
+    // Rounding to priceDecimals and scaling back may each add an ulp on top of half a unit.
+    const double tolerance = config.priceCodec == PriceCodec::Xor ? 0.0 : 0.5001 / std::pow(10.0, config.priceDecimals);
+    return mismatchedTimes == 0 && maxError <= tolerance && streamed == ticks;
+}
@@ -12,6 +12,8 @@
 
 size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* response);
 void scrape(std::vector<std::string> symbols, std::string targetDate);
+std::vector<std::pair<std::string, std::string>> fetchDay(const std::vector<std::string>& symbols, const std::string& targetDate);
+std::vector<StockPrice> parseDay(const std::vector<std::pair<std::string, std::string>>& rawData, const std::string& targetDate);
 std::string fetchStockData(const std::string& symbol, const std::string targetDate);
 std::vector<StockPrice> parseStockData(const std::string ticker, const std::string& jsonData, const std::string& targetDate);
 
@@ -45,29 +47,56 @@ size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* res
  */
 void scrape(std::vector<std::string> symbols, std::string targetDate, Profiler& profiler, bool persist = false){
     profiler.startComponent("Web Scraper");
+
+    std::vector<StockPrice> prices = parseDay(fetchDay(symbols, targetDate), targetDate);
+
+    if (persist) 
+        write("ticker,date,price", "exchange_prices.csv", prices);
     
+    profiler.stopComponent("Web Scraper");
+    
+    interpolate(prices, profiler);
+}
+
+/**
+ * @brief Fetches the raw stock data of every symbol for one target date.
+ *
+ * This is the network-bound half of scrape(), split out so the pipelined controller can
+ * run it as its own stage.
+ *
+ * @param symbols Vector of stock symbols to fetch data for.
+ * @param targetDate The target date for which data is to be fetched.
+ * @return The (symbol, JSON response) pairs, in the order of symbols.
+ */
+std::vector<std::pair<std::string, std::string>> fetchDay(const std::vector<std::string>& symbols, const std::string& targetDate) {
     redis_client.connect("localhost", 6379, [](const std::string& host, std::size_t port, cpp_redis::client::connect_state status) {
         if (status == cpp_redis::client::connect_state::dropped) {
             std::cout << "Lost connection to Redis at " << host << ":" << port << std::endl;
         }
     });
 
-    std::vector<StockPrice> prices;
+    std::vector<std::pair<std::string, std::string>> rawData;
+    for (const std::string& symbol : symbols)
+        rawData.emplace_back(symbol, fetchStockData(symbol, targetDate));
 
-    for (const std::string& symbol : symbols) {
-        std::string jsonData = fetchStockData(symbol, targetDate);
+    redis_client.disconnect();
+    return rawData;
+}
+
+/**
+ * @brief Parses the raw stock data of every symbol for one target date.
+ *
+ * @param rawData The (symbol, JSON response) pairs returned by fetchDay.
+ * @param targetDate The target date to filter data for.
+ * @return The parsed prices of all symbols, concatenated in the order of rawData.
+ */
+std::vector<StockPrice> parseDay(const std::vector<std::pair<std::string, std::string>>& rawData, const std::string& targetDate) {
+    std::vector<StockPrice> prices;
+    for (const auto& [symbol, jsonData] : rawData) {
         std::vector<StockPrice> cur_prices = parseStockData(symbol, jsonData, targetDate);
         prices.insert(prices.end(), cur_prices.begin(), cur_prices.end());
     }
-    
-    redis_client.disconnect();
-
-    if (persist) 
-        write("ticker,date,price", "exchange_prices.csv", prices);
-    
-    profiler.stopComponent("Web Scraper");
-    
-    interpolate(prices, profiler);
+    return prices;
 }
 
 /**
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef MARKET_DAY_H
+#define MARKET_DAY_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "stock_price.h"
+
+/**
+ * One trading day's worth of market data as it moves through the pipeline stages.
+ * Each stage fills in the next field: the raw API responses per symbol, then the parsed
+ * minute prices, then the interpolated millisecond prices.
+ */
+struct MarketDay {
+    std::string date;
+    std::vector<std::pair<std::string, std::string>> rawData; // (symbol, JSON response)
+    std::vector<StockPrice> prices;
+};
+
+/**
+ * A batch of ticks handed from the consume stage to the trade stage. The last batch of each
+ * day carries no ticks and has endOfDay set.
+ */
+struct TickBatch {
+    std::string date;
+    std::vector<StockPrice> ticks;
+    bool endOfDay = false;
+    int64_t nextOffset = -1; // Kafka offset following the batch; -1 when the ticks did not come from Kafka
+    int64_t consumedNs = 0;  // Pipeline clock time the consume stage emitted the batch
+};
+
+#endif // MARKET_DAY_H
@@ -1,5 +1,5 @@
 #include "stock_trade.h"
 
 void StockTrade::print() {
-    std::cout << "Ticker: " << ticker << ", Time: " << timestamp << ", Quantity: " << qty << std::endl;
+    std::cout << "Ticker: " << ticker << ", Time: " << timestamp << ", Quantity: " << qty << ", Price: " << price << std::endl;
 }
\ No newline at end of file
@@ -10,9 +10,10 @@ struct StockTrade {
     std::string ticker;   // Stock ticker symbol
     std::string timestamp; // Timestamp of the trade
     size_t qty;          // Quantity of stocks traded
+    double price;        // Execution price per share
 
-    StockTrade(const std::string& ticker, const std::string& timestamp, size_t qty)
-        : ticker(ticker), timestamp(timestamp), qty(qty) {}
+    StockTrade(const std::string& ticker, const std::string& timestamp, size_t qty, double price = 0.0)
+        : ticker(ticker), timestamp(timestamp), qty(qty), price(price) {}
 
     // Print method to display the trade details
     void print();
@@ -56,3 +56,12 @@ void write(const std::string header, const std::string destination, std::vector<
         std::cerr << "Error opening the file: " << destination << std::endl;
     }
 }
+
+uint32_t symbolPartition(const std::string& ticker, uint32_t partitionCount) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : ticker) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash % partitionCount;
+}
@@ -6,6 +6,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cstdint>
 #include "stock_price.h"
 
 //File persistence
@@ -15,6 +16,7 @@ const std::string interpolatedFile = "interpolated_prices.csv";
 //Kafka
 const std::string brokerAddr = "localhost:9092";
 const std::string topicName = "PRICES";
+const std::string endOfDayKey = "__END_OF_DAY__"; // Marker message closing each published trading day
 
 /*
  * Splits a string into a vector of substrings based on the delimiter ','.
@@ -38,5 +40,14 @@ std::vector<StockPrice> read(const std::string sourceFile);
  */
 void write(const std::string header, const std::string targetFile, std::vector<StockPrice> prices);
 
+/*
+ * Maps a ticker to a partition with a stable FNV-1a hash, so publishers and sharded consumers
+ * agree on symbol ownership across processes and builds.
+ * @param ticker The stock ticker.
+ * @param partitionCount The number of partitions; must be non-zero.
+ * @return The partition index in [0, partitionCount).
+ */
+uint32_t symbolPartition(const std::string& ticker, uint32_t partitionCount);
+
 
 #endif // UTIL_H
@@ -0,0 +1,132 @@
+#pragma once
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+#include "wait_strategy.h"
+
+/**
+ * @class BoundedQueue
+ * @brief A blocking multi-producer, multi-consumer FIFO with a fixed capacity.
+ *
+ * push() blocks while the queue is full, which is how backpressure propagates from a slow
+ * pipeline stage to the stages feeding it. The queue also samples its depth on every push
+ * so the pipeline can report how full each hand-off ran.
+ *
+ * Consumers choose how they wait: the spinning strategies poll a lock-free size hint and only
+ * take the lock once an item is there, so a pinned consumer can pick up an item without a
+ * futex wakeup.
+ */
+template <typename T>
+class BoundedQueue {
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    std::deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+    std::atomic<size_t> sizeHint_{0};
+    std::atomic<bool> closedHint_{false};
+
+    size_t maxDepth_ = 0;
+    size_t depthSum_ = 0;
+    size_t depthSamples_ = 0;
+
+public:
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(capacity ? capacity : 1) {}
+
+    /**
+     * @brief Appends an item, blocking while the queue is full.
+     * @return False if the queue was closed and the item was dropped.
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_)
+            return false;
+
+        items_.push_back(std::move(item));
+        sizeHint_.store(items_.size(), std::memory_order_release);
+        depthSum_ += items_.size();
+        ++depthSamples_;
+        if (items_.size() > maxDepth_)
+            maxDepth_ = items_.size();
+
+        lock.unlock();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item, waiting with the given strategy while the queue is empty.
+     * @param strategy Spinning strategies poll before falling back to the blocking wait.
+     * @return False once the queue is closed and fully drained.
+     */
+    bool pop(T& item, WaitStrategy strategy = WaitStrategy::Blocking) {
+        if (strategy != WaitStrategy::Blocking) {
+            for (uint32_t idlePolls = 0;
+                 sizeHint_.load(std::memory_order_acquire) == 0 && !closedHint_.load(std::memory_order_acquire);
+                 idlePolls++)
+                idleBackoff(strategy, idlePolls);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty())
+            return false;
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        sizeHint_.store(items_.size(), std::memory_order_release);
+
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Marks the end of the stream. Consumers drain the remaining items and then stop.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            closedHint_.store(true, std::memory_order_release);
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+    /**
+     * @brief Whether close() has been called; items may still be queued.
+     */
+    bool closed() const {
+        return closedHint_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return sizeHint_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    size_t maxDepth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return maxDepth_;
+    }
+
+    double averageDepth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return depthSamples_ ? static_cast<double>(depthSum_) / depthSamples_ : 0.0;
+    }
+};
+
+#endif
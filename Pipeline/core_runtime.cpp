@@ -0,0 +1,68 @@
+#include "core_runtime.h"
+
+#include <alloca.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+// From <numaif.h>; declared here so the runtime does not depend on libnuma.
+constexpr int kMpolLocal = 4;
+}
+
+bool pinCurrentThread(int core) {
+    long cores = sysconf(_SC_NPROCESSORS_CONF);
+    if (core < 0 || core >= cores || core >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+bool bindMemoryToLocalNode() {
+#ifdef SYS_set_mempolicy
+    return syscall(SYS_set_mempolicy, kMpolLocal, nullptr, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+bool lockProcessMemory() {
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+void unlockProcessMemory() {
+    munlockall();
+}
+
+ProcessMemoryLock::ProcessMemoryLock(bool lock) : locked_(lock && lockProcessMemory()) {}
+
+ProcessMemoryLock::~ProcessMemoryLock() {
+    if (locked_)
+        unlockProcessMemory();
+}
+
+void prefaultStack(size_t bytes) {
+    volatile char* stack = static_cast<volatile char*>(alloca(bytes));
+    for (size_t offset = 0; offset < bytes; offset += 4096)
+        stack[offset] = 0;
+}
+
+void enterStageRuntime(const std::string& stageName, const StageRuntime& runtime,
+                       const RuntimeConfig& config, size_t workerIndex) {
+    if (runtime.core >= 0) {
+        int core = runtime.core + static_cast<int>(workerIndex);
+        if (!pinCurrentThread(core))
+            std::cerr << "Failed to pin " << stageName << " worker to core " << core << std::endl;
+        // Only meaningful once the thread stays on one node; unsupported policies are not an error.
+        bindMemoryToLocalNode();
+        prefaultStack(config.stackPrefaultBytes);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#ifndef CORE_RUNTIME_H
+#define CORE_RUNTIME_H
+
+#include <cstddef>
+#include <string>
+
+#include "wait_strategy.h"
+
+/**
+ * @struct StageRuntime
+ * @brief Core placement and wait strategy of one pipeline stage.
+ */
+struct StageRuntime {
+    int core = -1;                                  // First core to pin workers to; -1 leaves placement to the OS
+    WaitStrategy waitStrategy = WaitStrategy::Blocking;
+};
+
+/**
+ * @struct RuntimeConfig
+ * @brief Process-wide memory settings applied before the pipeline starts.
+ */
+struct RuntimeConfig {
+    bool lockMemory = false;                // mlockall current and future pages so hot buffers never fault
+    size_t stackPrefaultBytes = 256 * 1024; // Stack touched by each pinned worker before it starts
+};
+
+/**
+ * @brief Pins the calling thread to a single core.
+ * @return False if the core does not exist or the affinity call failed.
+ */
+bool pinCurrentThread(int core);
+
+/**
+ * @brief Makes the calling thread allocate new pages on the NUMA node of the core it runs on.
+ * @return False on kernels or containers where the memory policy cannot be set.
+ */
+bool bindMemoryToLocalNode();
+
+/**
+ * @brief Locks every current and future page of the process into RAM, prefaulting them.
+ * @return False if the locked-memory limit does not allow it.
+ */
+bool lockProcessMemory();
+
+/**
+ * @brief Releases the locks taken by lockProcessMemory().
+ */
+void unlockProcessMemory();
+
+/**
+ * @class ProcessMemoryLock
+ * @brief Locks process memory for the lifetime of a run and unlocks it afterwards.
+ *
+ * MCL_FUTURE otherwise stays in effect for the rest of the process, so a later run configured
+ * without the lock would still fault every new page in and count against the locked-memory limit.
+ */
+class ProcessMemoryLock {
+private:
+    bool locked_;
+
+public:
+    /**
+     * @brief Locks process memory if requested.
+     * @param lock Whether to lock; a failure leaves the memory unlocked and is reported by locked().
+     */
+    explicit ProcessMemoryLock(bool lock);
+    ~ProcessMemoryLock();
+
+    ProcessMemoryLock(const ProcessMemoryLock&) = delete;
+    ProcessMemoryLock& operator=(const ProcessMemoryLock&) = delete;
+
+    bool locked() const { return locked_; }
+};
+
+/**
+ * @brief Touches the given amount of the calling thread's stack so it is resident before use.
+ */
+void prefaultStack(size_t bytes);
+
+/**
+ * @brief Applies a stage's runtime settings to the calling worker thread.
+ *
+ * Pins to core + workerIndex when a core is configured, switches the thread to NUMA-local
+ * allocation and prefaults its stack. Failures are reported and the worker keeps running
+ * unpinned, so the same configuration works on machines with fewer cores or inside containers.
+ *
+ * @param stageName The stage name used in diagnostics.
+ * @param runtime The stage runtime settings.
+ * @param config The process-wide runtime settings.
+ * @param workerIndex The index of the worker within its stage.
+ */
+void enterStageRuntime(const std::string& stageName, const StageRuntime& runtime,
+                       const RuntimeConfig& config, size_t workerIndex);
+
+#endif
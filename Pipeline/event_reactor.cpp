@@ -0,0 +1,207 @@
+#include "event_reactor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "pipeline_stage.h"
+
+EventNotifier::EventNotifier() : fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), firstNotifyNs_(0) {
+    if (fd_ < 0)
+        std::cerr << "Failed to create eventfd: " << std::strerror(errno) << std::endl;
+}
+
+EventNotifier::~EventNotifier() {
+    if (fd_ >= 0)
+        close(fd_);
+}
+
+void EventNotifier::notify() {
+    int64_t expected = 0;
+    firstNotifyNs_.compare_exchange_strong(expected, pipelineClockNanoseconds(), std::memory_order_relaxed);
+    uint64_t one = 1;
+    // EAGAIN only means the counter is saturated, which still leaves the descriptor readable.
+    if (write(fd_, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        std::cerr << "Failed to signal eventfd: " << std::strerror(errno) << std::endl;
+}
+
+uint64_t EventNotifier::consume(int64_t& firstNotifyNs) {
+    uint64_t signals = 0;
+    if (read(fd_, &signals, sizeof(signals)) < 0)
+        signals = 0;
+    firstNotifyNs = firstNotifyNs_.exchange(0, std::memory_order_relaxed);
+    return signals;
+}
+
+bool EventNotifier::wait(std::chrono::milliseconds timeout) {
+    pollfd descriptor{fd_, POLLIN, 0};
+    while (true) {
+        int ready = poll(&descriptor, 1, static_cast<int>(timeout.count()));
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+            return false;
+        int64_t firstNotifyNs;
+        consume(firstNotifyNs);
+        return true;
+    }
+}
+
+EventReactor::EventReactor(std::chrono::milliseconds idleTimeout)
+    : epollFd_(epoll_create1(EPOLL_CLOEXEC)),
+      stopRequested_(false),
+      idleTimeout_(idleTimeout),
+      wakeups_(0),
+      idlePeriods_(0) {
+    if (epollFd_ < 0) {
+        std::cerr << "Failed to create epoll instance: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    add(std::make_unique<Source>(SourceKind::Stop, stopNotifier_.fd(), &stopNotifier_, nullptr, 0, "Stop"));
+}
+
+EventReactor::~EventReactor() {
+    for (const auto& source : sources_) {
+        if (source->kind == SourceKind::Timer)
+            close(source->fd);
+    }
+    if (epollFd_ >= 0)
+        close(epollFd_);
+}
+
+bool EventReactor::add(std::unique_ptr<Source> source) {
+    if (epollFd_ < 0 || source->fd < 0)
+        return false;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = source.get();
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, source->fd, &event) != 0) {
+        std::cerr << "Failed to watch " << source->stats.name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    sources_.push_back(std::move(source));
+    return true;
+}
+
+bool EventReactor::addNotifier(EventNotifier& notifier, const std::string& name, Handler handler) {
+    return add(std::make_unique<Source>(SourceKind::Notifier, notifier.fd(), &notifier, std::move(handler), 0, name));
+}
+
+bool EventReactor::addTimer(std::chrono::nanoseconds interval, const std::string& name, Handler handler) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to create timer " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval.count() / 1000000000;
+    spec.it_interval.tv_nsec = interval.count() % 1000000000;
+    spec.it_value = spec.it_interval;
+    // steady_clock is CLOCK_MONOTONIC on Linux, so deadlines are comparable with pipelineClockNanoseconds().
+    const int64_t firstDeadlineNs = pipelineClockNanoseconds() + interval.count();
+    if (timerfd_settime(fd, 0, &spec, nullptr) != 0) {
+        std::cerr << "Failed to arm timer " << name << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+    auto source = std::make_unique<Source>(SourceKind::Timer, fd, nullptr, std::move(handler), interval.count(), name);
+    source->nextDeadlineNs = firstDeadlineNs;
+    if (!add(std::move(source))) {
+        close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool EventReactor::dispatch(Source& source) {
+    const int64_t entryNs = pipelineClockNanoseconds();
+    if (source.kind == SourceKind::Timer) {
+        uint64_t expirations = 0;
+        if (read(source.fd, &expirations, sizeof(expirations)) < 0 || expirations == 0)
+            return false;
+        const int64_t deadlineNs = source.nextDeadlineNs + static_cast<int64_t>(expirations - 1) * source.intervalNs;
+        if (entryNs >= deadlineNs)
+            source.stats.wakeupLatency.record(entryNs - deadlineNs);
+        source.nextDeadlineNs = deadlineNs + source.intervalNs;
+        source.stats.timerOverruns += expirations - 1;
+    } else {
+        int64_t firstNotifyNs;
+        if (source.notifier->consume(firstNotifyNs) == 0)
+            return false;
+        if (firstNotifyNs > 0 && entryNs >= firstNotifyNs)
+            source.stats.wakeupLatency.record(entryNs - firstNotifyNs);
+    }
+    ++source.stats.dispatches;
+    if (source.handler)
+        source.handler();
+    return source.kind == SourceKind::Notifier;
+}
+
+void EventReactor::run() {
+    if (epollFd_ < 0)
+        return;
+    const int64_t idleNs = std::chrono::duration_cast<std::chrono::nanoseconds>(idleTimeout_).count();
+    int64_t idleDeadlineNs = pipelineClockNanoseconds() + idleNs;
+    epoll_event events[32];
+    while (!stopRequested_.load(std::memory_order_acquire)) {
+        // Timers keep firing while the market is quiet, so idleness is tracked against its own deadline.
+        int timeoutMs = -1;
+        if (idleNs > 0)
+            timeoutMs = static_cast<int>(std::max<int64_t>(idleDeadlineNs - pipelineClockNanoseconds() + 999999, 0) / 1000000);
+        int ready = epoll_wait(epollFd_, events, 32, timeoutMs);
+        if (ready < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        if (ready > 0)
+            ++wakeups_;
+        bool active = false;
+        for (int i = 0; i < ready && !stopRequested_.load(std::memory_order_acquire); i++)
+            active |= dispatch(*static_cast<Source*>(events[i].data.ptr));
+
+        const int64_t nowNs = pipelineClockNanoseconds();
+        if (active) {
+            idleDeadlineNs = nowNs + idleNs;
+        } else if (idleNs > 0 && nowNs >= idleDeadlineNs) {
+            ++idlePeriods_;
+            idleDeadlineNs = nowNs + idleNs;
+        }
+    }
+    stopRequested_.store(false, std::memory_order_release);
+}
+
+void EventReactor::stop() {
+    stopRequested_.store(true, std::memory_order_release);
+    stopNotifier_.notify();
+}
+
+std::vector<ReactorSourceStats> EventReactor::stats() const {
+    std::vector<ReactorSourceStats> result;
+    for (const auto& source : sources_) {
+        if (source->kind != SourceKind::Stop)
+            result.push_back(source->stats);
+    }
+    return result;
+}
+
+void EventReactor::printReport() const {
+    std::cout << "Event reactor: " << wakeups_ << " wakeups, " << idlePeriods_ << " idle periods of "
+              << idleTimeout_.count() << "ms" << std::endl;
+    for (const ReactorSourceStats& source : stats()) {
+        std::cout << "  " << source.name << ": " << source.dispatches << " dispatches";
+        if (source.timerOverruns)
+            std::cout << ", " << source.timerOverruns << " overruns";
+        if (source.wakeupLatency.count())
+            std::cout << ", wakeup p50 " << source.wakeupLatency.percentile(50) << "ns p99 "
+                      << source.wakeupLatency.percentile(99) << "ns max " << source.wakeupLatency.max() << "ns";
+        std::cout << std::endl;
+    }
+}
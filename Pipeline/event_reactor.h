@@ -0,0 +1,164 @@
+#pragma once
+
+#ifndef EVENT_REACTOR_H
+#define EVENT_REACTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Profiler/latency_histogram.h"
+
+/**
+ * @class EventNotifier
+ * @brief An eventfd that one thread signals and an EventReactor, or a blocked consumer, waits on.
+ *
+ * notify() stamps the time of the first signal since the last consume(), so the waiting side can
+ * measure the wakeup latency from the signal to its handler. Signals that arrive while one is
+ * already pending are coalesced by the eventfd counter. The descriptor can also be handed to a
+ * library that writes to it directly, such as a librdkafka queue; those signals carry no stamp.
+ */
+class EventNotifier {
+private:
+    int fd_;
+    std::atomic<int64_t> firstNotifyNs_;
+
+public:
+    EventNotifier();
+    ~EventNotifier();
+
+    EventNotifier(const EventNotifier&) = delete;
+    EventNotifier& operator=(const EventNotifier&) = delete;
+
+    int fd() const { return fd_; }
+    bool valid() const { return fd_ >= 0; }
+
+    /**
+     * @brief Signals the waiting side. Safe to call from any thread.
+     */
+    void notify();
+
+    /**
+     * @brief Resets the notifier.
+     * @param firstNotifyNs[out] The pipeline clock time of the first coalesced notify(), or 0 if unknown.
+     * @return The number of signals consumed.
+     */
+    uint64_t consume(int64_t& firstNotifyNs);
+
+    /**
+     * @brief Blocks until the notifier is signalled, then consumes it.
+     * @param timeout How long to wait; a negative timeout waits indefinitely.
+     * @return False if the timeout elapsed first.
+     */
+    bool wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+};
+
+/**
+ * @struct ReactorSourceStats
+ * @brief Dispatch counts and wakeup latency of one EventReactor source.
+ */
+struct ReactorSourceStats {
+    std::string name;
+    uint64_t dispatches = 0;
+    uint64_t timerOverruns = 0;       // Timer expirations coalesced into an earlier dispatch
+    LatencyHistogram wakeupLatency;   // From notify() or the timer deadline to handler entry
+};
+
+/**
+ * @class EventReactor
+ * @brief A single-threaded epoll loop over notifiers and timers.
+ *
+ * Handlers run to completion on the thread that calls run(), one at a time, so they can share
+ * state without locks. The loop ends only when stop() is called, which is how an owner signals
+ * an explicit end of session. An idle timeout without notifier events, timers aside, is counted
+ * as an idle period and never ends the loop. The reactor is reusable: run() may be called
+ * again after it returns.
+ */
+class EventReactor {
+public:
+    using Handler = std::function<void()>;
+
+private:
+    enum class SourceKind {
+        Notifier,
+        Timer,
+        Stop
+    };
+
+    struct Source {
+        Source(SourceKind kind, int fd, EventNotifier* notifier, Handler handler, int64_t intervalNs, const std::string& name)
+            : kind(kind), fd(fd), notifier(notifier), handler(std::move(handler)), intervalNs(intervalNs), nextDeadlineNs(0) {
+            stats.name = name;
+        }
+
+        SourceKind kind;
+        int fd;
+        EventNotifier* notifier;
+        Handler handler;
+        int64_t intervalNs;
+        int64_t nextDeadlineNs;
+        ReactorSourceStats stats;
+    };
+
+    int epollFd_;
+    EventNotifier stopNotifier_;
+    std::vector<std::unique_ptr<Source>> sources_;
+    std::atomic<bool> stopRequested_;
+    std::chrono::milliseconds idleTimeout_;
+    uint64_t wakeups_;
+    uint64_t idlePeriods_;
+
+    bool add(std::unique_ptr<Source> source);
+    bool dispatch(Source& source);
+
+public:
+    /**
+     * @brief Constructor to initialize the EventReactor.
+     * @param idleTimeout The interval without notifier events that counts as one idle period; 0 disables idle detection.
+     */
+    explicit EventReactor(std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(1000));
+    ~EventReactor();
+
+    EventReactor(const EventReactor&) = delete;
+    EventReactor& operator=(const EventReactor&) = delete;
+
+    bool valid() const { return epollFd_ >= 0; }
+
+    /**
+     * @brief Calls handler on the reactor thread whenever the notifier is signalled.
+     *
+     * The notifier is consumed before the handler runs, so a signal raised while the handler
+     * runs schedules another dispatch. The notifier must outlive the reactor.
+     */
+    bool addNotifier(EventNotifier& notifier, const std::string& name, Handler handler);
+
+    /**
+     * @brief Calls handler on the reactor thread every interval, starting one interval from now.
+     */
+    bool addTimer(std::chrono::nanoseconds interval, const std::string& name, Handler handler);
+
+    /**
+     * @brief Dispatches events on the calling thread until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Ends run() once the current handler returns. Safe to call from handlers and other threads.
+     */
+    void stop();
+
+    uint64_t wakeups() const { return wakeups_; }
+    uint64_t idlePeriods() const { return idlePeriods_; }
+    std::vector<ReactorSourceStats> stats() const;
+
+    /**
+     * @brief Prints one line per source with its dispatches and wakeup latency.
+     */
+    void printReport() const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "in_process_transport.h"
+
+#include <atomic>
+
+#include "../Model/util.h"
+
+InProcessTransport::InProcessTransport(size_t partitionCount, size_t capacityPerPartition) {
+    for (size_t i = 0; i < (partitionCount ? partitionCount : 1); i++)
+        partitions_.push_back(std::make_unique<Partition>(capacityPerPartition));
+}
+
+void InProcessTransport::push(size_t partition, const TransportMessage& message) {
+    Partition& target = *partitions_[partition];
+    for (uint32_t idlePolls = 0; !target.ring.tryPush(message); idlePolls++)
+        idleBackoff(WaitStrategy::SpinThenYield, idlePolls);
+    // Pairs with the fence in arm(): either the consumer sees this message before sleeping,
+    // or this thread sees the consumer armed and wakes it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (target.armed.load(std::memory_order_relaxed) && target.armed.exchange(false, std::memory_order_relaxed))
+        target.notifier.notify();
+}
+
+void InProcessTransport::publish(const StockPrice& price) {
+    push(symbolPartition(price.ticker, static_cast<uint32_t>(partitions_.size())), {price, false});
+}
+
+void InProcessTransport::publishEndOfDay() {
+    for (size_t partition = 0; partition < partitions_.size(); partition++)
+        push(partition, {StockPrice("", "", 0.0), true});
+}
+
+bool InProcessTransport::arm(size_t partition) {
+    Partition& source = *partitions_[partition];
+    source.armed.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (source.ring.empty())
+        return true;
+    source.armed.store(false, std::memory_order_relaxed);
+    return false;
+}
+
+size_t InProcessTransport::poll(size_t partition, std::vector<StockPrice>& out, size_t maxMessages, bool& endOfDay) {
+    SpscRing<TransportMessage>& ring = partitions_[partition]->ring;
+    TransportMessage message;
+    size_t taken = 0;
+    endOfDay = false;
+    while (taken < maxMessages && ring.tryPop(message)) {
+        ++taken;
+        if (message.endOfDay) {
+            endOfDay = true;
+            break;
+        }
+        out.push_back(std::move(message.price));
+    }
+    return taken;
+}
+
+bool InProcessTransport::consume(size_t partition, std::vector<StockPrice>& out, size_t maxMessages,
+                                 WaitStrategy strategy) {
+    Partition& source = *partitions_[partition];
+    TransportMessage message;
+
+    for (uint32_t idlePolls = 0; !source.ring.tryPop(message); idlePolls++) {
+        if (strategy != WaitStrategy::Blocking)
+            idleBackoff(strategy, idlePolls);
+        else if (arm(partition))
+            source.notifier.wait();
+    }
+
+    size_t taken = 0;
+    while (true) {
+        if (message.endOfDay)
+            return true;
+        out.push_back(std::move(message.price));
+        if (++taken == maxMessages || !source.ring.tryPop(message))
+            return false;
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#ifndef IN_PROCESS_TRANSPORT_H
+#define IN_PROCESS_TRANSPORT_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "event_reactor.h"
+#include "spsc_ring.h"
+#include "wait_strategy.h"
+#include "../Model/stock_price.h"
+
+/**
+ * @struct TransportMessage
+ * @brief One entry of an in-process partition: a tick or an end-of-day marker.
+ */
+struct TransportMessage {
+    StockPrice price{"", "", 0.0};
+    bool endOfDay = false;
+};
+
+/**
+ * @class InProcessTransport
+ * @brief A partitioned, Kafka-shaped market data transport that never leaves the process.
+ *
+ * Ticks are routed to partitions with the same symbol hash the KafkaPublisher uses, and each
+ * partition is a lock-free single-producer, single-consumer ring. It lets the pipeline and the
+ * sharded trader be exercised and benchmarked without a broker. One thread publishes; each
+ * partition is consumed by exactly one thread.
+ *
+ * A consumer that wants to sleep arms its partition first; the publisher signals the
+ * partition's EventNotifier only while it is armed, so a busy stream costs no system calls.
+ */
+class InProcessTransport {
+private:
+    struct Partition {
+        explicit Partition(size_t capacity) : ring(capacity) {}
+
+        SpscRing<TransportMessage> ring;
+        EventNotifier notifier;
+        std::atomic<bool> armed{false};
+    };
+
+    std::vector<std::unique_ptr<Partition>> partitions_;
+
+    void push(size_t partition, const TransportMessage& message);
+
+public:
+    /**
+     * @brief Constructor to initialize the InProcessTransport.
+     * @param partitionCount The number of partitions, normally one per consumer shard.
+     * @param capacityPerPartition Messages each partition buffers before the publisher waits.
+     */
+    InProcessTransport(size_t partitionCount, size_t capacityPerPartition);
+
+    size_t partitionCount() const { return partitions_.size(); }
+
+    /**
+     * @brief Routes a tick to its symbol's partition, waiting while that partition is full.
+     */
+    void publish(const StockPrice& price);
+
+    /**
+     * @brief Appends an end-of-day marker to every partition.
+     */
+    void publishEndOfDay();
+
+    /**
+     * @brief The notifier signalled when a message reaches an armed partition, for an EventReactor.
+     */
+    EventNotifier& notifier(size_t partition) { return partitions_[partition]->notifier; }
+
+    /**
+     * @brief Asks for a signal on the next message, before the consumer goes to sleep.
+     * @return False if messages are already waiting; the partition is then left unarmed and
+     *         the consumer should keep draining instead of sleeping.
+     */
+    bool arm(size_t partition);
+
+    /**
+     * @brief Takes up to maxMessages ticks from a partition without waiting.
+     * @param endOfDay[out] Set if the end-of-day marker was consumed; ticks that preceded it are still appended.
+     * @return The number of messages taken, counting the end-of-day marker.
+     */
+    size_t poll(size_t partition, std::vector<StockPrice>& out, size_t maxMessages, bool& endOfDay);
+
+    /**
+     * @brief Takes up to maxMessages ticks from a partition, waiting for at least one message.
+     * @param partition The partition owned by the calling consumer.
+     * @param out[out] The ticks are appended to it.
+     * @param maxMessages Upper bound on the ticks taken in one call.
+     * @param strategy How to wait while the partition is empty; Blocking sleeps on the partition's notifier.
+     * @return True if the end-of-day marker was consumed. Ticks that preceded it are still appended.
+     */
+    bool consume(size_t partition, std::vector<StockPrice>& out, size_t maxMessages, WaitStrategy strategy);
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "pipeline_stage.h"
+
+#include <iomanip>
+#include <iostream>
+
+void printPipelineReport(const std::vector<StageStats>& stages, double wallSeconds) {
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+
+    std::cout << "Pipeline stages:" << std::endl;
+    double sumOfBusy = 0.0;
+    const StageStats* bottleneck = nullptr;
+    for (const StageStats& stage : stages) {
+        std::cout << std::fixed << std::setprecision(3)
+                  << stage.name << " (x" << stage.parallelism << ", " << waitStrategyName(stage.waitStrategy) << "): "
+                  << stage.itemsIn << " in, " << stage.itemsOut << " out, "
+                  << "busy " << stage.busySeconds << "s, "
+                  << "occupancy " << stage.occupancy() * 100.0 << "%, "
+                  << "input stall " << stage.inputStallSeconds << "s, "
+                  << "output stall " << stage.outputStallSeconds << "s, "
+                  << "input depth avg " << stage.averageInputDepth
+                  << " max " << stage.maxInputDepth << "/" << stage.inputCapacity
+                  << ", wakeup p50 " << stage.wakeupLatency.percentile(50)
+                  << "ns p99 " << stage.wakeupLatency.percentile(99) << "ns" << std::endl;
+
+        sumOfBusy += stage.busySeconds;
+        double perWorker = stage.busySeconds / (stage.parallelism ? stage.parallelism : 1);
+        if (!bottleneck || perWorker > bottleneck->busySeconds / (bottleneck->parallelism ? bottleneck->parallelism : 1))
+            bottleneck = &stage;
+    }
+
+    std::cout << "Pipeline wall time: " << wallSeconds << " seconds" << std::endl;
+    std::cout << "Sum of stage busy time (sequential estimate): " << sumOfBusy << " seconds" << std::endl;
+    if (bottleneck)
+        std::cout << "Bottleneck stage: " << bottleneck->name << std::endl;
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,282 @@
+#pragma once
+
+#ifndef PIPELINE_STAGE_H
+#define PIPELINE_STAGE_H
+
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "core_runtime.h"
+#include "../Profiler/latency_histogram.h"
+
+/**
+ * @struct Sequenced
+ * @brief An item travelling through the pipeline tagged with its position in the stream.
+ */
+template <typename T>
+struct Sequenced {
+    uint64_t sequence = 0;
+    T value;
+    int64_t enqueuedNs = 0; // Steady-clock time the item was handed to the queue; 0 if untimed
+};
+
+/**
+ * @brief Steady-clock nanoseconds used to timestamp hand-offs between stages.
+ */
+inline int64_t pipelineClockNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @struct StageStats
+ * @brief Occupancy and stall figures reported for one pipeline stage.
+ */
+struct StageStats {
+    std::string name;
+    size_t parallelism = 0;
+    WaitStrategy waitStrategy = WaitStrategy::Blocking;
+    uint64_t itemsIn = 0;
+    uint64_t itemsOut = 0;
+    double busySeconds = 0.0;         // Time spent inside the stage function, summed over workers
+    double inputStallSeconds = 0.0;   // Time workers waited for upstream items
+    double outputStallSeconds = 0.0;  // Time workers waited on backpressure or to emit in order
+    double wallSeconds = 0.0;         // Time from start() until the last worker exited
+    double averageInputDepth = 0.0;
+    size_t maxInputDepth = 0;
+    size_t inputCapacity = 0;
+    LatencyHistogram wakeupLatency;   // Time from an item reaching an idle worker's queue to the worker picking it up
+
+    /**
+     * @brief Fraction of the available worker time spent doing work.
+     */
+    double occupancy() const {
+        return wallSeconds > 0.0 && parallelism ? busySeconds / (wallSeconds * parallelism) : 0.0;
+    }
+};
+
+/**
+ * @brief Prints one line per stage plus the pipeline-wide wall time and bottleneck.
+ * @param stages The statistics of every stage, in pipeline order.
+ * @param wallSeconds The wall-clock duration of the whole pipeline run.
+ */
+void printPipelineReport(const std::vector<StageStats>& stages, double wallSeconds);
+
+/**
+ * @class PipelineStage
+ * @brief Runs a stage function on a pool of workers between two bounded queues.
+ *
+ * Each input may emit any number of outputs. With a single worker outputs are pushed
+ * downstream as soon as they are emitted; with several workers they are buffered per input
+ * and released strictly in input order, so parallel stages never reorder the stream.
+ * The output queue is closed when the last worker exits. A null output queue makes the
+ * stage a sink. Each worker applies the stage's StageRuntime before it starts: core pinning,
+ * NUMA-local allocation, and the wait strategy used on the input queue.
+ *
+ * If the stage function throws, the stage records the first exception and closes both of
+ * its queues, so upstream pushes fail instead of blocking and downstream stages drain and
+ * exit. The remaining inputs are discarded, and join() rethrows the exception.
+ */
+template <typename In, typename Out>
+class PipelineStage {
+public:
+    using Emit = std::function<void(Out&&)>;
+    using Function = std::function<void(In&, const Emit&)>;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string name_;
+    size_t parallelism_;
+    BoundedQueue<Sequenced<In>>& input_;
+    BoundedQueue<Sequenced<Out>>* output_;
+    Function function_;
+    StageRuntime runtime_;
+    RuntimeConfig runtimeConfig_;
+
+    std::vector<std::thread> workers_;
+    size_t activeWorkers_ = 0;
+    Clock::time_point startTime_;
+
+    std::mutex turnMutex_;
+    std::condition_variable turnChanged_;
+    uint64_t nextTurn_ = 0;
+    uint64_t nextOutputSequence_ = 0;
+
+    std::mutex statsMutex_;
+    StageStats stats_;
+
+    std::atomic<bool> failed_{false};
+    std::exception_ptr error_;
+
+    static double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    double pushOutput(Out&& value) {
+        if (!output_)
+            return 0.0;
+        Clock::time_point start = Clock::now();
+        output_->push({nextOutputSequence_++, std::move(value), pipelineClockNanoseconds()});
+        return secondsSince(start);
+    }
+
+    void fail(std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            if (!error_)
+                error_ = error;
+        }
+        failed_.store(true, std::memory_order_release);
+        input_.close();
+        if (output_)
+            output_->close();
+    }
+
+    void joinWorkers() {
+        for (std::thread& worker : workers_) {
+            if (worker.joinable())
+                worker.join();
+        }
+    }
+
+    void work(size_t workerIndex) {
+        enterStageRuntime(name_, runtime_, runtimeConfig_, workerIndex);
+
+        StageStats local;
+        Sequenced<In> item;
+        while (true) {
+            Clock::time_point waitStart = Clock::now();
+            int64_t waitStartNs = pipelineClockNanoseconds();
+            bool received = input_.pop(item, runtime_.waitStrategy);
+            local.inputStallSeconds += secondsSince(waitStart);
+            if (!received)
+                break;
+            ++local.itemsIn;
+            // Items that were already queued when the worker came looking measure backlog, not wakeup.
+            if (item.enqueuedNs >= waitStartNs)
+                local.wakeupLatency.record(pipelineClockNanoseconds() - item.enqueuedNs);
+
+            double outputStall = 0.0;
+            Clock::time_point workStart = Clock::now();
+            if (parallelism_ == 1) {
+                try {
+                    if (!failed_.load(std::memory_order_acquire)) {
+                        function_(item.value, [&](Out&& out) {
+                            outputStall += pushOutput(std::move(out));
+                            ++local.itemsOut;
+                        });
+                    }
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+                local.busySeconds += secondsSince(workStart) - outputStall;
+            } else {
+                std::vector<Out> buffered;
+                try {
+                    if (!failed_.load(std::memory_order_acquire))
+                        function_(item.value, [&](Out&& out) { buffered.push_back(std::move(out)); });
+                } catch (...) {
+                    buffered.clear();
+                    fail(std::current_exception());
+                }
+                local.busySeconds += secondsSince(workStart);
+
+                Clock::time_point turnStart = Clock::now();
+                std::unique_lock<std::mutex> lock(turnMutex_);
+                turnChanged_.wait(lock, [&] { return nextTurn_ == item.sequence; });
+                // After a failure inputs still take their turn, with nothing to push, so waiting workers can exit.
+                for (Out& out : buffered) {
+                    pushOutput(std::move(out));
+                    ++local.itemsOut;
+                }
+                ++nextTurn_;
+                lock.unlock();
+                turnChanged_.notify_all();
+                outputStall = secondsSince(turnStart);
+            }
+            local.outputStallSeconds += outputStall;
+        }
+
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.itemsIn += local.itemsIn;
+        stats_.itemsOut += local.itemsOut;
+        stats_.busySeconds += local.busySeconds;
+        stats_.inputStallSeconds += local.inputStallSeconds;
+        stats_.outputStallSeconds += local.outputStallSeconds;
+        stats_.wakeupLatency.merge(local.wakeupLatency);
+        if (--activeWorkers_ == 0) {
+            stats_.wallSeconds = secondsSince(startTime_);
+            if (output_)
+                output_->close();
+        }
+    }
+
+public:
+    PipelineStage(const std::string& name, size_t parallelism, BoundedQueue<Sequenced<In>>& input,
+                  BoundedQueue<Sequenced<Out>>* output, Function function,
+                  const StageRuntime& runtime = StageRuntime(), const RuntimeConfig& runtimeConfig = RuntimeConfig())
+        : name_(name),
+          parallelism_(parallelism ? parallelism : 1),
+          input_(input),
+          output_(output),
+          function_(std::move(function)),
+          runtime_(runtime),
+          runtimeConfig_(runtimeConfig) {}
+
+    ~PipelineStage() {
+        joinWorkers();
+    }
+
+    /**
+     * @brief Launches the stage's workers.
+     */
+    void start() {
+        startTime_ = Clock::now();
+        activeWorkers_ = parallelism_;
+        for (size_t i = 0; i < parallelism_; i++)
+            workers_.emplace_back(&PipelineStage::work, this, i);
+    }
+
+    /**
+     * @brief Waits for every worker to drain the input queue and exit.
+     *
+     * Rethrows the first exception the stage function threw, if any.
+     */
+    void join() {
+        joinWorkers();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            std::swap(error, error_);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /**
+     * @brief Returns the stage statistics. Only meaningful after join().
+     */
+    StageStats stats() {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        StageStats result = stats_;
+        result.name = name_;
+        result.parallelism = parallelism_;
+        result.waitStrategy = runtime_.waitStrategy;
+        result.averageInputDepth = input_.averageDepth();
+        result.maxInputDepth = input_.maxDepth();
+        result.inputCapacity = input_.capacity();
+        return result;
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class SpscRing
+ * @brief A lock-free single-producer, single-consumer ring buffer.
+ *
+ * The capacity is rounded up to a power of two. Head and tail live on separate cache lines,
+ * and each side caches the other side's index so the common case touches only its own line.
+ */
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+
+    alignas(64) std::atomic<size_t> head_{0}; // Next slot to read, owned by the consumer
+    size_t cachedTail_ = 0;
+    alignas(64) std::atomic<size_t> tail_{0}; // Next slot to write, owned by the producer
+    size_t cachedHead_ = 0;
+
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity)
+            size <<= 1;
+        return size;
+    }
+
+public:
+    explicit SpscRing(size_t capacity, const T& prototype = T())
+        : slots_(roundUp(capacity), prototype), mask_(slots_.size() - 1) {}
+
+    /**
+     * @brief Appends an item if there is room. Producer thread only.
+     * @return False if the ring is full.
+     */
+    bool tryPush(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == slots_.size()) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == slots_.size())
+                return false;
+        }
+        slots_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item if there is one. Consumer thread only.
+     * @return False if the ring is empty.
+     */
+    bool tryPop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_)
+                return false;
+        }
+        item = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Whether the ring holds no items. Consumer thread only.
+     */
+    bool empty() const {
+        return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef WAIT_STRATEGY_H
+#define WAIT_STRATEGY_H
+
+#include <cstdint>
+#include <thread>
+
+/**
+ * @enum WaitStrategy
+ * @brief How an idle pipeline thread waits for its next item.
+ */
+enum class WaitStrategy {
+    BusySpin,       // Poll continuously with a pause hint; lowest wakeup latency, burns the core
+    SpinThenYield,  // Poll for a bounded number of iterations, then yield the core between polls
+    Blocking        // Sleep on a condition variable or timeout until woken by the producer
+};
+
+/**
+ * @brief Number of polls SpinThenYield makes before it starts yielding.
+ */
+constexpr uint32_t kSpinBeforeYield = 4096;
+
+/**
+ * @brief Tells the CPU the caller is in a spin-wait loop.
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief Backs off one step of an idle poll loop according to the strategy.
+ * @param strategy The spinning strategy; Blocking callers wait elsewhere and never call this.
+ * @param idlePolls The number of consecutive empty polls so far.
+ */
+inline void idleBackoff(WaitStrategy strategy, uint32_t idlePolls) {
+    if (strategy == WaitStrategy::SpinThenYield && idlePolls >= kSpinBeforeYield)
+        std::this_thread::yield();
+    else
+        cpuRelax();
+}
+
+inline const char* waitStrategyName(WaitStrategy strategy) {
+    switch (strategy) {
+        case WaitStrategy::BusySpin: return "busy-spin";
+        case WaitStrategy::SpinThenYield: return "spin-then-yield";
+        case WaitStrategy::Blocking: return "blocking";
+    }
+    return "unknown";
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    ++counts_[bucketIndex(nanoseconds)];
+    ++count_;
+    sum_ += nanoseconds;
+    min_ = std::min(min_, nanoseconds);
+    max_ = std::max(max_, nanoseconds);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < kBucketCount; i++)
+        counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() {
+    counts_.fill(0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+double LatencyHistogram::mean() const {
+    return count_ ? static_cast<double>(sum_) / count_ : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (count_ == 0)
+        return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * count_));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += counts_[i];
+        if (seen >= rank)
+            return std::clamp(bucketMidpoint(i), min_, max_);
+    }
+    return max_;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets))
+        return static_cast<int>(value);
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBucketBits;
+    int subBucket = static_cast<int>((value >> shift) & (kSubBuckets - 1));
+    return ((shift + 1) << kSubBucketBits) + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketMidpoint(int index) {
+    if (index < kSubBuckets)
+        return static_cast<uint64_t>(index);
+
+    int shift = (index >> kSubBucketBits) - 1;
+    uint64_t subBucket = static_cast<uint64_t>(index & (kSubBuckets - 1));
+    uint64_t lower = (kSubBuckets + subBucket) << shift;
+    return lower + ((uint64_t(1) << shift) >> 1);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+/**
+ * @class LatencyHistogram
+ * @brief Fixed-size log-linear histogram of latency samples in nanoseconds.
+ *
+ * Every power of two is split into 16 linear sub-buckets, giving roughly 6% relative
+ * precision over the full 64-bit range. Recording never allocates, so it is safe to
+ * call from the critical path.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram();
+
+    void record(uint64_t nanoseconds);
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    /**
+     * @brief Returns the approximate value at the given percentile.
+     * @param percentile A percentile in [0, 100].
+     * @return The midpoint of the bucket containing the requested rank, in nanoseconds.
+     */
+    uint64_t percentile(double percentile) const;
+
+private:
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketMidpoint(int index);
+
+    std::array<uint64_t, kBucketCount> counts_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+const EventSpec kEvents[kPerfCounterCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                             | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+
+int openEvent(const EventSpec& spec, int groupFd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = groupFd < 0 ? 1 : 0;
+    // User space only, which perf_event_paranoid 2 still allows for the process's own threads. Page faults
+    // raised by user code are still counted. A context switch always happens in the kernel, so that event
+    // has to include it and is only available to privileged users or with perf_event_paranoid 1 or lower.
+    attr.exclude_kernel = spec.type == PERF_TYPE_SOFTWARE && spec.config == PERF_COUNT_SW_CONTEXT_SWITCHES ? 0 : 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+}
+
+const char* perfCounterName(PerfCounter counter) {
+    switch (counter) {
+        case PerfCounter::Cycles: return "cycles";
+        case PerfCounter::Instructions: return "instructions";
+        case PerfCounter::L1DMisses: return "L1D misses";
+        case PerfCounter::LLCMisses: return "LLC misses";
+        case PerfCounter::BranchMisses: return "branch misses";
+        case PerfCounter::ContextSwitches: return "context switches";
+        case PerfCounter::PageFaults: return "page faults";
+    }
+    return "unknown";
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other) {
+    for (size_t i = 0; i < kPerfCounterCount; i++)
+        values[i] += other.values[i];
+    availableMask |= other.availableMask;
+    return *this;
+}
+
+PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues& earlier) const {
+    PerfCounterValues delta;
+    delta.availableMask = availableMask & earlier.availableMask;
+    for (size_t i = 0; i < kPerfCounterCount; i++)
+        delta.values[i] = values[i] >= earlier.values[i] ? values[i] - earlier.values[i] : 0;
+    return delta;
+}
+
+PerfCounterGroup::PerfCounterGroup() : leaderFd_(-1), opened_(0), availableMask_(0) {
+    fds_.fill(-1);
+    slots_.fill(-1);
+    for (size_t i = 0; i < kPerfCounterCount; i++) {
+        int fd = openEvent(kEvents[i], leaderFd_);
+        if (fd < 0) {
+            if (!error_.empty())
+                error_ += "; ";
+            error_ += std::string(perfCounterName(static_cast<PerfCounter>(i))) + ": " + std::strerror(errno);
+            continue;
+        }
+        // The first counter that opens leads the group, so a machine without a PMU still counts software events.
+        if (leaderFd_ < 0)
+            leaderFd_ = fd;
+        fds_[i] = fd;
+        slots_[i] = static_cast<int>(opened_++);
+        availableMask_ |= 1u << i;
+    }
+    if (leaderFd_ >= 0) {
+        ioctl(leaderFd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leaderFd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    for (int fd : fds_) {
+        if (fd >= 0)
+            close(fd);
+    }
+}
+
+bool PerfCounterGroup::read(PerfCounterValues& out) const {
+    if (leaderFd_ < 0)
+        return false;
+    // Layout of a PERF_FORMAT_GROUP read: nr, time_enabled, time_running, then one value per counter.
+    uint64_t buffer[3 + kPerfCounterCount];
+    ssize_t bytes = ::read(leaderFd_, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != opened_)
+        return false;
+
+    const uint64_t enabled = buffer[1];
+    const uint64_t running = buffer[2];
+    // A group that was enabled but never got onto the PMU, e.g. while other groups hold every
+    // counter, read zeros that measured nothing; the group is scheduled as a whole, so none count.
+    if (enabled && !running)
+        return false;
+    out.availableMask = availableMask_;
+    for (size_t i = 0; i < kPerfCounterCount; i++) {
+        if (slots_[i] < 0) {
+            out.values[i] = 0;
+            continue;
+        }
+        uint64_t value = buffer[3 + slots_[i]];
+        if (running && running < enabled)
+            value = static_cast<uint64_t>(static_cast<double>(value) * enabled / running);
+        out.values[i] = value;
+    }
+    return true;
+}
+
+PerfCounterGroup& PerfCounterGroup::forCurrentThread() {
+    thread_local PerfCounterGroup group;
+    return group;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum PerfCounter
+ * @brief The hardware and software events a PerfCounterGroup counts.
+ */
+enum class PerfCounter {
+    Cycles,
+    Instructions,
+    L1DMisses,        // L1 data cache read misses
+    LLCMisses,        // Last-level cache misses
+    BranchMisses,
+    ContextSwitches,  // Counted in the kernel; unavailable to unprivileged users at perf_event_paranoid 2 or above
+    PageFaults        // Raised by user code, mostly first touches of freshly allocated memory
+};
+
+constexpr size_t kPerfCounterCount = 7;
+
+const char* perfCounterName(PerfCounter counter);
+
+/**
+ * @struct PerfCounterValues
+ * @brief A reading, or a difference of readings, of every counter of a group.
+ */
+struct PerfCounterValues {
+    std::array<uint64_t, kPerfCounterCount> values{};
+    uint32_t availableMask = 0; // Bit i is set if counter i was opened
+
+    bool available(PerfCounter counter) const { return availableMask & (1u << static_cast<int>(counter)); }
+    uint64_t operator[](PerfCounter counter) const { return values[static_cast<size_t>(counter)]; }
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other);
+    PerfCounterValues operator-(const PerfCounterValues& earlier) const;
+};
+
+/**
+ * @class PerfCounterGroup
+ * @brief A perf_event_open counter group measuring the calling thread in user space.
+ *
+ * All counters are opened as one group so they are scheduled onto the PMU together and read
+ * with a single read(). Counters the machine does not provide, such as cache events on some
+ * virtual machines, are left out individually; when none can be opened, typically because a
+ * container blocks perf_event_open or perf_event_paranoid forbids it, the group is invalid and
+ * reads fail. Values are scaled by enabled over running time when the kernel multiplexes,
+ * and reads fail while the kernel has not scheduled the group at all.
+ */
+class PerfCounterGroup {
+private:
+    std::array<int, kPerfCounterCount> fds_;
+    std::array<int, kPerfCounterCount> slots_; // Position of each counter in the group read, or -1
+    int leaderFd_;
+    size_t opened_;
+    uint32_t availableMask_;
+    std::string error_;
+
+public:
+    /**
+     * @brief Opens the counters for the calling thread; they count from construction on.
+     */
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool valid() const { return leaderFd_ >= 0; }
+    uint32_t availableMask() const { return availableMask_; }
+
+    /**
+     * @brief Why the group or one of its counters could not be opened; empty if all were.
+     */
+    const std::string& error() const { return error_; }
+
+    /**
+     * @brief Reads every counter of the group.
+     * @return False if the group is invalid, the read failed, or the group has not been
+     *         scheduled onto the PMU since it was enabled, so its values would all be zero.
+     */
+    bool read(PerfCounterValues& out) const;
+
+    /**
+     * @brief Returns the calling thread's group, opening it on first use.
+     */
+    static PerfCounterGroup& forCurrentThread();
+};
+
+#endif
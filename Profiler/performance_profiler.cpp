@@ -1,32 +1,145 @@
 #include "performance_profiler.h"
 
-Profiler::Profiler() {
-    startTime_ = std::chrono::steady_clock::now();
+#include <vector>
+
+namespace {
+/**
+ * A component scope entered on this thread and not yet stopped.
+ */
+struct OpenScope {
+    const Profiler* profiler;
+    std::string component;
+    std::chrono::steady_clock::time_point startTime;
+    bool counted;
+    PerfCounterValues start;
+};
+
+thread_local std::vector<OpenScope> openScopes;
 }
 
+Profiler::Profiler() : hardwareCounters_(false) {}
+
 void Profiler::startComponent(const std::string& componentName) {
-    componentTimes_[componentName] = 0.0;
-    componentTimes_[componentName] -= getCurrentTime();
+    // Read last, so the profiler's own bookkeeping is not attributed to the component.
+    PerfCounterValues start;
+    bool counted = hardwareCounters_.load(std::memory_order_relaxed) && PerfCounterGroup::forCurrentThread().read(start);
+    openScopes.push_back({this, componentName, std::chrono::steady_clock::now(), counted, start});
 }
 
 void Profiler::stopComponent(const std::string& componentName) {
-    componentTimes_[componentName] += getCurrentTime();
+    PerfCounterValues end;
+    bool counted = hardwareCounters_.load(std::memory_order_relaxed) && PerfCounterGroup::forCurrentThread().read(end);
+    auto endTime = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = openScopes.rbegin(); it != openScopes.rend(); ++it) {
+        if (it->profiler == this && it->component == componentName) {
+            componentTimes_[componentName] += std::chrono::duration<double>(endTime - it->startTime).count();
+            if (counted && it->counted) {
+                ComponentCounters& counters = componentCounters_[componentName];
+                counters.totals += end - it->start;
+                ++counters.scopes;
+            }
+            openScopes.erase(std::next(it).base());
+            break;
+        }
+    }
 }
 
 double Profiler::getTotalTime() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     double tot = 0.0;
     for(auto [k, v]: componentTimes_) tot += v;
     return tot;
 }
 
 void Profiler::printComponentTimes() const {
-    std::cout << "Component times:" << std::endl;
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "Component times (summed over every scope and thread):" << std::endl;
     for (const auto& entry : componentTimes_) {
         std::cout << entry.first << ": " << entry.second << " seconds" << std::endl;
     }
+
+    if (!componentLatencies_.empty()) {
+        std::cout << "Component latencies (ns):" << std::endl;
+        for (const auto& [name, histogram] : componentLatencies_) {
+            std::cout << name << ": n=" << histogram.count()
+                      << " mean=" << histogram.mean()
+                      << " p50=" << histogram.percentile(50)
+                      << " p99=" << histogram.percentile(99)
+                      << " p99.9=" << histogram.percentile(99.9)
+                      << " max=" << histogram.max() << std::endl;
+        }
+    }
+
+    bool header = false;
+    for (const auto& [name, counters] : componentCounters_) {
+        if (!counters.scopes)
+            continue;
+        if (!header) {
+            std::cout << "Component hardware counters (per tick where ticks were counted, otherwise totals):" << std::endl;
+            header = true;
+        }
+        const PerfCounterValues& totals = counters.totals;
+        const double perItem = counters.items ? 1.0 / counters.items : 1.0;
+        std::cout << name << ": scopes=" << counters.scopes;
+        if (counters.items)
+            std::cout << " ticks=" << counters.items;
+        if (totals.available(PerfCounter::Cycles) && totals.available(PerfCounter::Instructions))
+            std::cout << " IPC=" << (totals[PerfCounter::Cycles]
+                                         ? static_cast<double>(totals[PerfCounter::Instructions]) / totals[PerfCounter::Cycles]
+                                         : 0.0);
+        for (size_t i = 0; i < kPerfCounterCount; i++) {
+            PerfCounter counter = static_cast<PerfCounter>(i);
+            std::cout << " " << perfCounterName(counter) << "=";
+            if (totals.available(counter))
+                std::cout << totals[counter] * perItem;
+            else
+                std::cout << "n/a";
+        }
+        std::cout << std::endl;
+    }
+}
+
+bool Profiler::enableHardwareCounters() {
+    const PerfCounterGroup& group = PerfCounterGroup::forCurrentThread();
+    if (!group.valid()) {
+        std::cerr << "Hardware counters unavailable (" << group.error()
+                  << "); check /proc/sys/kernel/perf_event_paranoid or the container's seccomp profile" << std::endl;
+        return false;
+    }
+    // Reported once per process; every Profiler of a repeated run would otherwise repeat it.
+    static std::atomic<bool> partialReported(false);
+    if (!group.error().empty() && !partialReported.exchange(true))
+        std::cerr << "Some hardware counters are unavailable: " << group.error() << std::endl;
+    hardwareCounters_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void Profiler::countItems(const std::string& componentName, uint64_t items) {
+    if (!hardwareCounters_.load(std::memory_order_relaxed))
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    componentCounters_[componentName].items += items;
+}
+
+std::unordered_map<std::string, double> Profiler::componentTotalTimes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return componentTimes_;
+}
+
+ComponentCounters Profiler::componentCounters(const std::string& componentName) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = componentCounters_.find(componentName);
+    return it == componentCounters_.end() ? ComponentCounters() : it->second;
+}
+
+LatencyHistogram& Profiler::latencyHistogram(const std::string& componentName) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return componentLatencies_[componentName];
 }
 
-double Profiler::getCurrentTime() const {
-    auto currentTime = std::chrono::steady_clock::now();
-    return std::chrono::duration<double>(currentTime - startTime_).count();
+void Profiler::recordLatency(const std::string& componentName, uint64_t nanoseconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    componentLatencies_[componentName].record(nanoseconds);
 }
@@ -4,25 +4,83 @@
 #define PROFILER_H
 
 #include <iostream>
+#include <atomic>
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
+#include "latency_histogram.h"
+#include "perf_counters.h"
+
+/**
+ * @struct ComponentCounters
+ * @brief Hardware counter deltas accumulated over every scope of one component.
+ */
+struct ComponentCounters {
+    PerfCounterValues totals;
+    uint64_t scopes = 0;
+    uint64_t items = 0; // Ticks or other work units reported with countItems()
+};
+
 class Profiler {
 private:
     std::unordered_map<std::string, double> componentTimes_;
-    std::chrono::steady_clock::time_point startTime_;
+    std::unordered_map<std::string, LatencyHistogram> componentLatencies_;
+    std::unordered_map<std::string, ComponentCounters> componentCounters_;
+    std::atomic<bool> hardwareCounters_;
+    mutable std::mutex mutex_;
 
 public:
     Profiler();
 
+    /**
+     * @brief Opens a scope of the component on the calling thread.
+     *
+     * Scopes are tracked per thread, so the same component may be entered concurrently from
+     * several threads; each scope's duration is added to the component's time when it stops.
+     */
     void startComponent(const std::string& componentName);
     void stopComponent(const std::string& componentName);
     double getTotalTime() const;
     void printComponentTimes() const;
 
-private:
-    double getCurrentTime() const;
+    /**
+     * @brief Returns the latency histogram for a component, creating it on first use.
+     *
+     * The returned reference stays valid for the lifetime of the Profiler, so hot paths
+     * should look it up once and record into it directly instead of paying for a
+     * string hash per sample.
+     */
+    LatencyHistogram& latencyHistogram(const std::string& componentName);
+    void recordLatency(const std::string& componentName, uint64_t nanoseconds);
+
+    /**
+     * @brief Attributes hardware counter deltas to every component scope from now on.
+     *
+     * Each thread that enters a component opens its own perf_event counter group on first use,
+     * and each startComponent()/stopComponent() pair reads it, adding one read() per call.
+     *
+     * @return False if the counters cannot be opened here, e.g. in a container that blocks
+     *         perf_event_open; the profiler then keeps reporting wall-clock times only.
+     */
+    bool enableHardwareCounters();
+    bool hardwareCountersEnabled() const { return hardwareCounters_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Records the work units, e.g. ticks, a component processed, so counters are reported per unit.
+     */
+    void countItems(const std::string& componentName, uint64_t items);
+
+    /**
+     * @brief Returns the accumulated counters of a component; empty if it has none.
+     */
+    ComponentCounters componentCounters(const std::string& componentName) const;
+
+    /**
+     * @brief Returns the seconds spent in each component, summed over every scope and thread.
+     */
+    std::unordered_map<std::string, double> componentTotalTimes() const;
 };
 
 #endif 
@@ -0,0 +1,102 @@
+#include "conflation_cache.h"
+
+#include <algorithm>
+#include <iostream>
+
+ConflationCache::ConflationCache(const std::vector<std::string>& symbols, ConflationPolicy policy, Profiler& profiler,
+                                 const std::string& stalenessName)
+    : policy_(policy),
+      conflating_(false),
+      receivedTicks_(0),
+      deliveredTicks_(0),
+      conflatedTicks_(0),
+      staleness_(profiler.latencyHistogram(stalenessName)) {
+    values_.reserve(symbols.size());
+    dirtySymbols_.reserve(symbols.size());
+    for (const std::string& symbol : symbols)
+        indexFor(symbol);
+}
+
+uint32_t ConflationCache::indexFor(const std::string& ticker) {
+    auto it = symbolIndex_.find(ticker);
+    if (it != symbolIndex_.end())
+        return it->second;
+
+    uint32_t index = static_cast<uint32_t>(values_.size());
+    symbolIndex_.emplace(ticker, index);
+    values_.push_back(LastValue());
+    values_.back().ticker = ticker;
+    return index;
+}
+
+void ConflationCache::onTicks(const std::vector<StockPrice>& ticks, bool backlogged, int64_t consumedNs) {
+    auto arrival = consumedNs > 0 ? std::chrono::steady_clock::time_point(std::chrono::nanoseconds(consumedNs))
+                                  : std::chrono::steady_clock::now();
+    for (const StockPrice& tick : ticks) {
+        uint32_t index = indexFor(tick.ticker);
+        LastValue& value = values_[index];
+        if (!value.dirty) {
+            value.dirty = true;
+            value.open = value.high = value.low = tick.price;
+            dirtySymbols_.push_back(index);
+        }
+        value.high = std::max(value.high, tick.price);
+        value.low = std::min(value.low, tick.price);
+        value.time = tick.time;
+        value.price = tick.price;
+        value.arrival = arrival;
+        ++value.version;
+    }
+    receivedTicks_ += ticks.size();
+
+    if (policy_ != ConflationPolicy::DeliverAll && backlogged && !conflating_) {
+        // From here on only the latest value per symbol is delivered; the ticks kept so far are superseded.
+        conflating_ = true;
+        pendingTicks_.clear();
+    }
+    if (!conflating_)
+        pendingTicks_.insert(pendingTicks_.end(), ticks.begin(), ticks.end());
+}
+
+void ConflationCache::drain(std::vector<StockPrice>& out) {
+    out.clear();
+    summaries_.clear();
+    auto now = std::chrono::steady_clock::now();
+
+    if (!conflating_) {
+        out.swap(pendingTicks_);
+        deliveredTicks_ += out.size();
+    }
+
+    for (uint32_t index : dirtySymbols_) {
+        LastValue& value = values_[index];
+        uint64_t pending = value.version - value.deliveredVersion;
+
+        if (conflating_) {
+            out.push_back(StockPrice(value.ticker, value.time, value.price));
+            conflatedTicks_ += pending - 1;
+            ++deliveredTicks_;
+            if (policy_ == ConflationPolicy::ConflateOHLC)
+                summaries_.push_back({value.ticker, value.open, value.high, value.low, value.price, pending});
+        }
+
+        staleness_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - value.arrival).count());
+        value.deliveredVersion = value.version;
+        value.dirty = false;
+    }
+    dirtySymbols_.clear();
+    conflating_ = false;
+}
+
+const LastValue* ConflationCache::lastValue(const std::string& ticker) const {
+    auto it = symbolIndex_.find(ticker);
+    if (it == symbolIndex_.end() || values_[it->second].version == 0)
+        return nullptr;
+    return &values_[it->second];
+}
+
+void ConflationCache::printSummary() const {
+    std::cout << "Ticks received: " << receivedTicks_ << std::endl;
+    std::cout << "Ticks delivered to strategy: " << deliveredTicks_ << std::endl;
+    std::cout << "Ticks conflated: " << conflatedTicks_ << std::endl;
+}
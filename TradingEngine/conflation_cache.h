@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Model/stock_price.h"
+#include "../Profiler/performance_profiler.h"
+
+/**
+ * @enum ConflationPolicy
+ * @brief How ticks that arrive faster than the strategy consumes them are delivered.
+ */
+enum class ConflationPolicy {
+    DeliverAll,      // Every tick, in arrival order
+    ConflateLatest,  // Only the newest tick of each symbol updated since the last drain
+    ConflateOHLC     // The newest tick plus an open/high/low/close summary of the ticks it replaced
+};
+
+/**
+ * @struct LastValue
+ * @brief The cached state of one symbol.
+ */
+struct LastValue {
+    std::string ticker;
+    std::string time;
+    double price = 0.0;
+    uint64_t version = 0;           // Number of ticks received for this symbol
+    uint64_t deliveredVersion = 0;  // Version of the last tick handed to the strategy
+    std::chrono::steady_clock::time_point arrival; // When the consumer handed the newest tick over
+
+    // Summary of the ticks received since the last drain.
+    double open = 0.0;
+    double high = 0.0;
+    double low = 0.0;
+    bool dirty = false;
+};
+
+/**
+ * @struct TickSummary
+ * @brief OHLC summary of the ticks conflated into one delivered update.
+ */
+struct TickSummary {
+    std::string ticker;
+    double open;
+    double high;
+    double low;
+    double close;
+    uint64_t tickCount;
+};
+
+/**
+ * @class ConflationCache
+ * @brief A per-symbol last-value cache between the KafkaConsumer and the trading strategy.
+ *
+ * Ticks are absorbed into the cache as fast as they are consumed. When the strategy is ready
+ * for more data it drains the cache, and under the conflating policies receives at most one
+ * update per symbol regardless of how large the backlog grew, which keeps the delay between
+ * the newest price and the decision bounded by the universe size instead of the backlog.
+ * Conflation only starts once the consumer reports a backlog; until then every tick is
+ * delivered in arrival order, so a strategy that keeps up sees the same input under every
+ * policy.
+ */
+class ConflationCache {
+private:
+    ConflationPolicy policy_;
+    std::unordered_map<std::string, uint32_t> symbolIndex_;
+    std::vector<LastValue> values_;
+    std::vector<uint32_t> dirtySymbols_;
+    std::vector<StockPrice> pendingTicks_;
+    std::vector<TickSummary> summaries_;
+    bool conflating_;               // A backlog was reported since the last drain
+
+    uint64_t receivedTicks_;
+    uint64_t deliveredTicks_;
+    uint64_t conflatedTicks_;
+    LatencyHistogram& staleness_;
+
+    uint32_t indexFor(const std::string& ticker);
+
+public:
+    /**
+     * @brief Constructor to initialize the ConflationCache.
+     * @param symbols The symbols to pre-register; unknown symbols are added on first use.
+     * @param policy The delivery policy.
+     * @param profiler The profiler object that receives the staleness of delivered ticks, measured
+     *                 from the consumer handing a symbol's newest tick over to the drain delivering it.
+     * @param stalenessName The profiler histogram the staleness is recorded into.
+     */
+    ConflationCache(const std::vector<std::string>& symbols, ConflationPolicy policy, Profiler& profiler,
+                    const std::string& stalenessName = "Conflation Staleness");
+
+    /**
+     * @brief Absorbs newly consumed ticks into the cache.
+     * @param ticks The ticks returned by the consumer, in arrival order.
+     * @param backlogged Whether more ticks were already waiting behind these; the conflating
+     *                   policies conflate everything absorbed until the next drain once it is set.
+     * @param consumedNs Steady-clock nanoseconds at which the consumer handed the ticks over, so
+     *                   staleness includes the time they waited in the tick queue; 0 means now.
+     */
+    void onTicks(const std::vector<StockPrice>& ticks, bool backlogged, int64_t consumedNs = 0);
+
+    /**
+     * @brief Hands every pending update to the strategy according to the policy.
+     *
+     * Under ConflateOHLC the summaries of the delivered updates are available from
+     * summaries() until the next drain.
+     *
+     * @param out[out] Replaced with the updates to process. Unconflated ticks keep arrival order;
+     *                 conflated updates are ordered by each symbol's first pending tick.
+     */
+    void drain(std::vector<StockPrice>& out);
+
+    /**
+     * @brief Returns the cached state of a symbol, or nullptr if it has never ticked.
+     */
+    const LastValue* lastValue(const std::string& ticker) const;
+
+    const std::vector<TickSummary>& summaries() const { return summaries_; }
+    uint64_t receivedCount() const { return receivedTicks_; }
+    uint64_t deliveredCount() const { return deliveredTicks_; }
+    uint64_t conflatedCount() const { return conflatedTicks_; }
+
+    /**
+     * @brief Prints the received, delivered and conflated tick counts.
+     */
+    void printSummary() const;
+};
@@ -1,21 +1,111 @@
+#pragma once
+
 #include <iostream>
 #include <string>
 #include <vector>
 #include <thread>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
 #include <sqlite3.h>
 
 #include "../Model/stock_price.h"
+#include "../Model/market_day.h"
 #include "../Profiler/performance_profiler.h"
+#include "../Pipeline/bounded_queue.h"
+#include "../Pipeline/pipeline_stage.h"
+#include "../Pipeline/core_runtime.h"
+#include "../Pipeline/event_reactor.h"
 #include "../MarketData/web_scraper.cpp"
+#include "../MarketData/replay_publisher.cpp"
+#include "../MarketData/synthetic_generator.cpp"
+#include "../MarketData/tick_archive.cpp"
 
 #include "data_consumer.cpp"
 #include "trading_engine.h"
+#include "risk_manager.h"
+#include "trade_analytics.h"
+#include "conflation_cache.h"
+#include "cross_sectional.h"
+#include "state_snapshot.h"
 #include "position_calculator.cpp"
+#include "sharded_trader.cpp"
 
-void persistTrades(const std::vector<StockTrade>& trades);
+bool persistTrades(const std::vector<StockTrade>& trades, int64_t tradeSequence = -1);
+int64_t persistedTradeSequence();
 void insertTradesToDatabase(const std::vector<StockTrade>& trades);
-void calculateTradeStatistics(int& totalTrades, std::map<std::string, int>& tickerCounts);
+
+/**
+ * @enum TradePersistence
+ * @brief Where the persist stage writes the trades it receives.
+ */
+enum class TradePersistence {
+    SQLite,  // Appended to the TRADES table of trades.db
+    Discard  // Counted and dropped, to measure the pipeline without database writes
+};
+
+/**
+ * @struct PipelineRunStats
+ * @brief Totals of the last completed runTradingFramework() call.
+ */
+struct PipelineRunStats {
+    double wallSeconds = 0.0;
+    uint64_t ticksPublished = 0;
+    uint64_t tradesPersisted = 0;
+    std::vector<StageStats> stages;
+};
+
+/**
+ * @struct PipelineConfig
+ * @brief Stage parallelism, queue capacities and core placement of the controller's multi-day pipeline.
+ */
+struct PipelineConfig {
+    size_t fetchParallelism = 1;       // Fetch workers share the global Redis client
+    size_t parseParallelism = 2;
+    size_t interpolateParallelism = 1; // Each interpolation already fans out over its own threads
+    size_t dayQueueCapacity = 2;       // Days buffered between preparation stages
+    size_t tickQueueCapacity = 4096;   // Tick batches buffered between the consumer and the strategy
+    size_t tradeQueueCapacity = 1024;  // Trade batches buffered ahead of persistence
+    ReplayConfig replay;               // Pacing of the publish stage; speed 0 publishes each day at once
+    const SyntheticMarketData* syntheticSource = nullptr; // When set, replaces Alpha Vantage in the fetch and parse stages
+    const TickArchiveReader* archiveSource = nullptr;     // When set, days it holds are decoded instead of fetched;
+                                                          // tick-level days also skip interpolation
+    TickArchiveWriter* archiveSink = nullptr;             // When set, every published day is appended to it
+
+    // Latency-critical stages can be pinned to dedicated cores and given a spinning wait strategy.
+    RuntimeConfig runtime;
+    StageRuntime archiveRuntime;       // archiveSink's encoder threads inherit this placement
+    StageRuntime publishRuntime;
+    StageRuntime consumeRuntime;
+    StageRuntime strategyRuntime;
+    StageRuntime persistRuntime;
+
+    // With more than one shard the consume and trade steps run on sharding.shards symbol-owning threads.
+    ShardConfig sharding;
+    MarketDataTransport transport = MarketDataTransport::Kafka;
+    size_t transportCapacity = 65536;  // Ticks buffered per in-process partition
+
+    // When set, the trade stage evaluates the SIMD cross-sectional signal instead of the TradingEngine strategy.
+    bool crossSectional = false;
+    CrossSectionalConfig crossSectionalConfig;
+
+    // A Blocking single-shard consumer waits in an epoll reactor, which also runs the heartbeat timer and
+    // relays persistence completions to the checkpointer, instead of polling with 10ms timeouts.
+    bool eventReactor = true;
+    std::chrono::milliseconds heartbeatInterval{100}; // Empty batches sent while the market is quiet, so periodic trade-stage tasks still run
+    std::chrono::milliseconds idleTimeout{1000};      // Quiet time counted as one idle period; never ends the session
+
+    // Checkpoints of the trade stage for restarts; only used with a single shard reading Kafka.
+    std::string snapshotPath;          // Empty disables checkpointing and resuming
+    std::chrono::milliseconds checkpointInterval{100};
+
+    TradePersistence persistence = TradePersistence::SQLite;
+    bool printReport = true;           // Print the stage, reactor, checkpoint and trading reports after the run
+};
 
 /**
  * @class Controller
@@ -24,82 +114,593 @@ void calculateTradeStatistics(int& totalTrades, std::map<std::string, int>& tick
 class Controller { 
 private:
     TradingEngine& tradingEngine;
+    RiskManager& riskManager;
+    TradeAnalytics& analytics;
+    ConflationCache& conflationCache;
     double cash;
     int lookbackPeriod;
     const std::vector<std::string>& symbols;
     const std::vector<std::string>& targetDates;
+    PipelineConfig pipelineConfig;
     Profiler& profiler;
+    PipelineRunStats runStats;
+
+    bool archived(const std::string& date) const {
+        return pipelineConfig.archiveSource && pipelineConfig.archiveSource->dayIndex(date) != TickArchiveReader::npos;
+    }
 public:
     /**
      * @brief Constructor for the Controller class.
      * 
      * @param tradingEngine The trading engine object responsible for executing trading strategies.
+     * @param riskManager The pre-trade risk gate every order must pass before it is persisted.
+     * @param analytics The streaming trade analytics fed with every price update and fill.
+     * @param conflationCache The last-value cache that conflates ticks between the consumer and the strategy.
      * @param cash The initial cash amount for the trading engine to trade with.
      * @param lookbackPeriod The duration, in milliseconds, for the trading engine to receive historical prices for.
      * @param symbols A reference to a constant vector of strings representing stock symbols.
      * @param targetDates A reference to a constant vector of strings representing target dates for data retrieval.
+     * @param pipelineConfig The stage parallelism and queue capacities of the multi-day pipeline.
      * @param profiler The profiler object to be used for performance measurement.
      */
-    Controller(TradingEngine& tradingEngine, double cash, int lookbackPeriod,
+    Controller(TradingEngine& tradingEngine, RiskManager& riskManager, TradeAnalytics& analytics,
+           ConflationCache& conflationCache, double cash, int lookbackPeriod,
            const std::vector<std::string>& symbols, const std::vector<std::string>& targetDates,
-           Profiler& profiler) 
+           const PipelineConfig& pipelineConfig, Profiler& profiler) 
         : tradingEngine(tradingEngine),
+          riskManager(riskManager),
+          analytics(analytics),
+          conflationCache(conflationCache),
           cash(cash),
           lookbackPeriod(lookbackPeriod),
           symbols(symbols),
           targetDates(targetDates),
+          pipelineConfig(pipelineConfig),
           profiler(profiler) {}
+
+    /**
+     * @brief Returns the wall time, tick and trade counts and stage statistics of the last run.
+     */
+    const PipelineRunStats& lastRunStats() const { return runStats; }
+
     /**
      * @brief Runs the trading framework for the specified target dates.
      *
-     * This function runs the trading framework for a list of target dates. For each
-     * date, it scrapes the necessary data, maintains a sliding window of historical
-     * stock prices (lookbackWindow), and executes the trading strategy based on the
-     * data in the window. The window size is determined by the lookback period.
+     * This function runs the trading framework for a list of target dates as a staged
+     * pipeline: fetch -> parse -> interpolate -> archive -> publish -> consume -> trade -> persist, connected by
+     * bounded queues. While one day is being traded, the following days are fetched,
+     * parsed and interpolated, so a multi-day run approaches the throughput of its slowest
+     * stage instead of the sum of all stages. A full queue blocks the stage feeding it,
+     * which bounds how far data preparation can run ahead of trading.
+     *
+     * With PipelineConfig::archiveSink set, the archive stage encodes each day into the tick
+     * archive on its own worker, so the encoder threads never share the publish core.
+     *
+     * The publish stage hands each day to the consume stage before it publishes the day's
+     * ticks, so the consumer drains a day while it is being published instead of after.
+     *
+     * The consume stage polls Kafka and hands tick batches to the trade stage. The trade
+     * stage absorbs them into the ConflationCache and only drains it once no further batch
+     * is queued, so when the strategy falls behind the 10ms cadence it is handed the newest
+     * price per symbol instead of an ever-growing backlog. It maintains a
+     * sliding window of historical stock prices
+     * (lookbackWindow) and executes the trading strategy based on the data in the window.
+     * The window size is determined by the lookback period. Every order the strategy
+     * returns passes through the RiskManager before it is persisted or applied to holdings
+     * and cash. Prices and fills are also fed to the TradeAnalytics, which produces the
+     * final report.
+     *
+     * @note The consume stage reads Kafka messages in batches of at most sharding.maxBatch,
+     *       keeping those stamped within the lookback period, the same filter the shard
+     *       consumers apply, until it reads the end-of-day marker the publish stage writes
+     *       after each day.
+     *
+     * The publish, consume, trade and persist stages run on the cores and with the wait
+     * strategies configured in PipelineConfig; each stage's wakeup latency is reported by
+     * the profiler per wait strategy so the strategies can be compared.
      *
-     * @note The function consumes new Kafka messages every 10 milliseconds and
-     *       maintains a sliding window of historical data. The sliding window ensures
-     *       that the data for the specified lookback period is always available for
-     *       the trading strategy.
+     * With more than one shard configured, ticks are partitioned by symbol hash and the
+     * consume stage hands each day to a ShardedTrader, whose shards consume, conflate, risk
+     * check and trade their own symbols in parallel against a shared cash ledger. The trade
+     * stage then only sees end-of-day markers, and the report covers the merged shards
+     * instead of the controller's own analytics, risk gate and conflation cache. The
+     * in-process transport replaces Kafka between the publish and consume steps; it
+     * ignores the replay pacing.
+     *
+     * With PipelineConfig::crossSectional set, the single trade stage replaces the
+     * TradingEngine strategy with a CrossSectionalStrategy, which evaluates every symbol
+     * of the universe in one SIMD pass per drained batch.
+     *
+     * With PipelineConfig::snapshotPath set, the trade stage periodically hands its cash,
+     * holdings, lookback window, analytics, consumer offset and trade count to a Checkpointer,
+     * and always does so at the end of each day. On the next run, the latest snapshot is
+     * mapped before any stage starts, and the analytics, the risk gate's positions and the
+     * cross-sectional strategy's positions continue from it. Completed days are skipped. The interrupted day is
+     * published again in full, and the consumer skips the part of the new copy that the
+     * snapshot already reflects, together with whatever the interrupted run left on the
+     * topic. Publishing a day waits until the previous day's final checkpoint is written,
+     * so only the resumed day can be partially on the topic. Trades emitted after the last
+     * checkpoint are persisted again after a restart.
+     *
+     * Each batch is stamped when the consume stage emits it. The single trade stage records
+     * the time from the oldest batch absorbed into a decision to the end of that decision in
+     * the profiler's "Tick To Decision" histogram.
      */
     void runTradingFramework() {
         profiler.startComponent("Controller");
+        auto pipelineStart = std::chrono::steady_clock::now();
 
         double cash = this->cash;
-        double currentProfitsLosses = 0.0;
         std::unordered_map<std::string, double> currentHoldings;
-        for (const std::string& date : targetDates) {
-            scrape(symbols, date, profiler);
-            
-            KafkaConsumer kafkaConsumer(profiler);
-            
-            std::deque<StockPrice> lookbackWindow; 
+        std::deque<StockPrice> lookbackWindow;
+
+        const size_t shardCount = std::max<size_t>(pipelineConfig.sharding.shards, 1);
+        const bool checkpointing = !pipelineConfig.snapshotPath.empty() && shardCount == 1
+                                   && pipelineConfig.transport == MarketDataTransport::Kafka;
+        ControllerState restored;
+        size_t firstDay = 0;
+        if (checkpointing && StateSnapshotFile(pipelineConfig.snapshotPath).load(restored)) {
+            auto it = std::find(targetDates.begin(), targetDates.end(), restored.date);
+            if (it != targetDates.end()) {
+                size_t day = it - targetDates.begin();
+                firstDay = restored.dayComplete ? day + 1 : day;
+                cash = restored.cash;
+                currentHoldings.insert(restored.holdings.begin(), restored.holdings.end());
+                lookbackWindow.assign(restored.lookbackWindow.begin(), restored.lookbackWindow.end());
+                analytics.restore(restored.analytics);
+                // The risk gate learns the restored positions at their average cost, the price it would have seen.
+                for (const SymbolMetrics& metrics : restored.analytics.symbols)
+                    riskManager.addPosition(metrics.ticker, metrics.position, metrics.position * metrics.averageCost);
+                std::cout << "Resuming " << restored.date << (restored.dayComplete ? " (complete)" : "")
+                          << " from offset " << restored.consumerOffset << std::endl;
+            } else {
+                std::cerr << "Snapshot date " << restored.date << " is not a target date; starting from scratch" << std::endl;
+                restored = ControllerState();
+            }
+        }
+        std::unique_ptr<Checkpointer> checkpointer;
+        if (checkpointing)
+            checkpointer = std::make_unique<Checkpointer>(pipelineConfig.snapshotPath, pipelineConfig.checkpointInterval,
+                                                          restored.tradeSequence);
+
+        // Checkpointed runs store how many trades are persisted in trades.db along with them. A resumed
+        // run replays the trades emitted after its snapshot and skips those the interrupted run stored.
+        const bool sequencedPersistence = checkpointing && pipelineConfig.persistence == TradePersistence::SQLite;
+        uint64_t persistedBeforeRun = restored.tradeSequence;
+        if (sequencedPersistence) {
+            if (restored.date.empty()) {
+                persistTrades({}, 0);
+            } else {
+                int64_t stored = persistedTradeSequence();
+                if (stored > static_cast<int64_t>(restored.tradeSequence))
+                    persistedBeforeRun = static_cast<uint64_t>(stored);
+            }
+        }
+
+        using DayStage = PipelineStage<MarketDay, MarketDay>;
+        using ConsumeStage = PipelineStage<MarketDay, TickBatch>;
+        using TradeStage = PipelineStage<TickBatch, std::vector<StockTrade>>;
+        using PersistStage = PipelineStage<std::vector<StockTrade>, std::vector<StockTrade>>;
+
+        BoundedQueue<Sequenced<MarketDay>> dateQueue(targetDates.size());
+        BoundedQueue<Sequenced<MarketDay>> fetchedQueue(pipelineConfig.dayQueueCapacity);
+        BoundedQueue<Sequenced<MarketDay>> parsedQueue(pipelineConfig.dayQueueCapacity);
+        BoundedQueue<Sequenced<MarketDay>> interpolatedQueue(pipelineConfig.dayQueueCapacity);
+        BoundedQueue<Sequenced<MarketDay>> archivedQueue(pipelineConfig.dayQueueCapacity);
+        BoundedQueue<Sequenced<MarketDay>> publishedQueue(pipelineConfig.dayQueueCapacity);
+        BoundedQueue<Sequenced<TickBatch>> tickQueue(pipelineConfig.tickQueueCapacity);
+        BoundedQueue<Sequenced<std::vector<StockTrade>>> tradeQueue(pipelineConfig.tradeQueueCapacity);
+
+        // Held until the run returns, so later runs in the same process start unlocked.
+        ProcessMemoryLock memoryLock(pipelineConfig.runtime.lockMemory);
+        if (pipelineConfig.runtime.lockMemory && !memoryLock.locked())
+            std::cerr << "Failed to lock process memory: " << std::strerror(errno) << std::endl;
+
+        DayStage fetchStage("Fetch", pipelineConfig.fetchParallelism, dateQueue, &fetchedQueue,
+            [this](MarketDay& day, const DayStage::Emit& emit) {
+                if (!pipelineConfig.syntheticSource && !archived(day.date))
+                    day.rawData = fetchDay(symbols, day.date);
+                emit(std::move(day));
+            });
+
+        DayStage parseStage("Parse", pipelineConfig.parseParallelism, fetchedQueue, &parsedQueue,
+            [this](MarketDay& day, const DayStage::Emit& emit) {
+                if (archived(day.date)) {
+                    const TickArchiveReader* archive = pipelineConfig.archiveSource;
+                    day.prices = archive->tickLevel(day.date) ? archive->decodeDay(day.date)
+                                                              : archive->decodeDayBySymbol(day.date);
+                } else if (const SyntheticMarketData* synthetic = pipelineConfig.syntheticSource) {
+                    size_t dayIndex = synthetic->dayIndex(day.date);
+                    if (dayIndex != SyntheticMarketData::npos)
+                        day.prices = synthetic->dayPrices(dayIndex);
+                    else
+                        std::cerr << "No synthetic data for " << day.date << std::endl;
+                } else {
+                    day.prices = parseDay(day.rawData, day.date);
+                }
+                day.rawData.clear();
+                emit(std::move(day));
+            });
+
+        DayStage interpolateStage("Interpolate", pipelineConfig.interpolateParallelism, parsedQueue, &interpolatedQueue,
+            [this](MarketDay& day, const DayStage::Emit& emit) {
+                if (archived(day.date) && pipelineConfig.archiveSource->tickLevel(day.date)) {
+                    emit(std::move(day));
+                    return;
+                }
+                std::vector<StockPrice> interpolatedPrices;
+                interpolateStockPricesMultiThread(day.prices, interpolatedPrices);
+                day.prices = std::move(interpolatedPrices);
+                emit(std::move(day));
+            });
+
+        // Days are appended to the archive in date order, so it runs on a single worker.
+        DayStage archiveStage("Archive", 1, interpolatedQueue, &archivedQueue,
+            [this](MarketDay& day, const DayStage::Emit& emit) {
+                if (pipelineConfig.archiveSink)
+                    pipelineConfig.archiveSink->addDay(day.date, day.prices);
+                emit(std::move(day));
+            }, pipelineConfig.archiveRuntime, pipelineConfig.runtime);
+
+        uint64_t publishedTicks = 0;
+        std::unique_ptr<InProcessTransport> transport;
+        if (pipelineConfig.transport == MarketDataTransport::InProcess)
+            transport = std::make_unique<InProcessTransport>(shardCount, pipelineConfig.transportCapacity);
+
+        // While checkpointing, a day is only published once the previous one was traded and its final
+        // checkpoint written, so a restart never finds more than the resumed day partially on the topic.
+        std::mutex tradedDaysMutex;
+        std::condition_variable tradedDaysChanged;
+        size_t tradedDays = 0;
+        size_t publishedDays = 0;
+
+        // Publishing, trading and persistence are order-dependent, so they always run on a single worker.
+        KafkaPublisher kafkaPublisher(profiler, shardCount > 1 ? static_cast<int32_t>(shardCount) : 0);
+        ReplayPublisher replayPublisher(kafkaPublisher, pipelineConfig.replay, profiler);
+        DayStage publishStage("Publish", 1, archivedQueue, &publishedQueue,
+            [&](MarketDay& day, const DayStage::Emit& emit) {
+                if (checkpointing) {
+                    std::unique_lock<std::mutex> lock(tradedDaysMutex);
+                    // A failed trade stage closes tickQueue and never counts another day.
+                    while (tradedDays < publishedDays && !tickQueue.closed())
+                        tradedDaysChanged.wait_for(lock, std::chrono::milliseconds(100));
+                }
+                ++publishedDays;
+                publishedTicks += day.prices.size();
+                // Hand the day to the consume stage before publishing it, so the consumer drains the
+                // day while it is published; in-process partitions only hold transportCapacity ticks.
+                const std::string date = day.date;
+                std::vector<StockPrice> prices = std::move(day.prices);
+                day.prices.clear();
+                emit(std::move(day));
+                if (transport) {
+                    for (const StockPrice& price : prices)
+                        transport->publish(price);
+                    transport->publishEndOfDay();
+                    return;
+                }
+                if (pipelineConfig.replay.speed > 0.0)
+                    replayPublisher.replay(prices).print();
+                else
+                    kafkaPublisher.publish(prices);
+                kafkaPublisher.publishEndOfDay(date);
+            }, pipelineConfig.publishRuntime, pipelineConfig.runtime);
+
+        std::unique_ptr<ShardedTrader> shardedTrader;
+        std::atomic<uint64_t> shardedTradeSequence(0);
+        if (shardCount > 1) {
+            ShardConfig shardConfig = pipelineConfig.sharding;
+            shardConfig.lookbackPeriod = lookbackPeriod;
+            shardConfig.runtimeConfig = pipelineConfig.runtime;
+            shardedTrader = std::make_unique<ShardedTrader>(tradingEngine, symbols, cash, shardConfig, transport.get(),
+                [&](std::vector<StockTrade>&& trades) {
+                    tradeQueue.push({shardedTradeSequence++, std::move(trades), pipelineClockNanoseconds()});
+                }, profiler);
+        }
+
+        EventNotifier kafkaNotifier;
+        EventNotifier persistedNotifier;
+        KafkaConsumer kafkaConsumer(profiler);
+        kafkaConsumer.setWaitStrategy(pipelineConfig.consumeRuntime.waitStrategy);
+        // The resumed day is published again after anything the interrupted run left on the topic,
+        // so the consumer skips that leftover and the new copy's prefix the snapshot already reflects.
+        int64_t resumeOffset = restored.consumerOffset;
+        int64_t dayStartOffset = restored.dayStartOffset;
+        if (!restored.date.empty()) {
+            int64_t endOffset = kafkaConsumer.endOffset();
+            if (endOffset > dayStartOffset) {
+                resumeOffset = endOffset + (restored.consumerOffset - restored.dayStartOffset);
+                dayStartOffset = endOffset;
+            }
+        }
+        kafkaConsumer.seek(resumeOffset);
+
+        // The reactor runs on the consume worker. Each day it dispatches market data until the
+        // end-of-day marker stops it; quiet periods only produce heartbeats and idle counts.
+        EventReactor reactor(pipelineConfig.idleTimeout);
+        std::atomic<uint64_t> persistedTrades(0);
+        // Trades up to this sequence are persisted; snapshots are only written once it covers their trades.
+        std::atomic<uint64_t> persistedSequence(restored.tradeSequence);
+        // While set, the reactor relays persistence completions; otherwise the persist stage reports them itself.
+        std::atomic<bool> reactorSession(false);
+        auto reportPersisted = [&]() {
+            if (checkpointer)
+                checkpointer->persisted(persistedSequence.load());
+        };
+        bool useReactor = pipelineConfig.eventReactor && shardCount == 1
+                          && pipelineConfig.consumeRuntime.waitStrategy == WaitStrategy::Blocking && reactor.valid()
+                          && (transport || kafkaConsumer.enableEventNotification(kafkaNotifier));
+        std::string reactorDate;
+        const ConsumeStage::Emit* reactorEmit = nullptr;
+        bool dataSinceHeartbeat = false;
+        auto consumerOffset = [&]() { return transport ? int64_t(-1) : kafkaConsumer.offset(); };
+        auto drainMarketData = [&]() {
+            dataSinceHeartbeat = true;
+            const size_t maxBatch = pipelineConfig.sharding.maxBatch;
             while (true) {
-                std::vector<StockPrice> newData = kafkaConsumer.consumeMessages(10);
-                
-                if (newData.empty())
-                    break;
+                std::vector<StockPrice> ticks;
+                bool endOfDay = false;
+                size_t taken;
+                if (transport) {
+                    taken = transport->poll(0, ticks, maxBatch, endOfDay);
+                } else {
+                    taken = kafkaConsumer.pollMessages(lookbackPeriod, ticks, maxBatch);
+                    endOfDay = kafkaConsumer.endOfDayReached();
+                }
+                if (!ticks.empty())
+                    (*reactorEmit)(TickBatch{reactorDate, std::move(ticks), false, consumerOffset()});
+                if (endOfDay) {
+                    reactor.stop();
+                    return;
+                }
+                // Kafka signals again when its queue refills; the transport only once the partition is armed.
+                if (taken < maxBatch && (!transport || transport->arm(0)))
+                    return;
+            }
+        };
+        if (useReactor) {
+            reactor.addNotifier(transport ? transport->notifier(0) : kafkaNotifier, "Market Data", drainMarketData);
+            reactor.addTimer(pipelineConfig.heartbeatInterval, "Heartbeat", [&]() {
+                if (reactorEmit && !dataSinceHeartbeat)
+                    (*reactorEmit)(TickBatch{reactorDate, {}, false, consumerOffset()});
+                dataSinceHeartbeat = false;
+            });
+            if (checkpointer)
+                reactor.addNotifier(persistedNotifier, "Persistence", reportPersisted);
+        }
+
+        ConsumeStage consumeStage("Consume", 1, publishedQueue, &tickQueue,
+            [&](MarketDay& day, const ConsumeStage::Emit& stageEmit) {
+                const ConsumeStage::Emit emit = [&](TickBatch&& batch) {
+                    batch.consumedNs = pipelineClockNanoseconds();
+                    stageEmit(std::move(batch));
+                };
+                if (shardedTrader) {
+                    shardedTrader->tradeDay();
+                    emit(TickBatch{day.date, {}, true});
+                    return;
+                }
+                if (useReactor) {
+                    reactorDate = day.date;
+                    reactorEmit = &emit;
+                    reactorSession.store(true);
+                    // Messages queued before the reactor started waiting raised no signal.
+                    drainMarketData();
+                    reactor.run();
+                    reactorEmit = nullptr;
+                    // Completions signalled before the session ended may not have been dispatched.
+                    reactorSession.store(false);
+                    reportPersisted();
+                    if (!transport)
+                        kafkaConsumer.startNextDay();
+                    emit(TickBatch{day.date, {}, true, consumerOffset()});
+                    return;
+                }
+                if (transport) {
+                    bool endOfDay = false;
+                    while (!endOfDay) {
+                        std::vector<StockPrice> ticks;
+                        endOfDay = transport->consume(0, ticks, pipelineConfig.sharding.maxBatch,
+                                                      pipelineConfig.consumeRuntime.waitStrategy);
+                        if (!ticks.empty())
+                            emit(TickBatch{day.date, std::move(ticks), false});
+                    }
+                    emit(TickBatch{day.date, {}, true});
+                    return;
+                }
+                while (!kafkaConsumer.endOfDayReached()) {
+                    std::vector<StockPrice> ticks = kafkaConsumer.consumeMessages(lookbackPeriod, pipelineConfig.sharding.maxBatch);
+                    if (!ticks.empty())
+                        emit(TickBatch{day.date, std::move(ticks), false, kafkaConsumer.offset()});
+                }
+                kafkaConsumer.startNextDay();
+                emit(TickBatch{day.date, {}, true, kafkaConsumer.offset()});
+            }, pipelineConfig.consumeRuntime, pipelineConfig.runtime);
+
+        std::unique_ptr<CrossSectionalStrategy> crossSectional;
+        if (pipelineConfig.crossSectional) {
+            crossSectional = std::make_unique<CrossSectionalStrategy>(symbols, pipelineConfig.crossSectionalConfig, profiler);
+            for (const auto& holding : currentHoldings)
+                crossSectional->setPosition(holding.first, holding.second);
+        }
 
-                lookbackWindow.erase(lookbackWindow.begin(), lookbackWindow.end() - newData.size());
-                lookbackWindow.insert(lookbackWindow.end(), newData.begin(), newData.end());
+        std::vector<StockPrice> newData;
+        LatencyHistogram& decisionLatency = profiler.latencyHistogram("Tick To Decision");
+        int64_t oldestPendingNs = 0;
+        int64_t consumedOffset = resumeOffset;
+        uint64_t tradeSequence = restored.tradeSequence;
+        TradeStage tradeStage("Trade", 1, tickQueue, &tradeQueue,
+            [&](TickBatch& batch, const TradeStage::Emit& emit) {
+                conflationCache.onTicks(batch.ticks, tickQueue.size() > 0, batch.consumedNs);
+                if (!batch.ticks.empty() && oldestPendingNs == 0)
+                    oldestPendingNs = batch.consumedNs;
+                if (batch.nextOffset >= 0)
+                    consumedOffset = batch.nextOffset;
+                // Keep absorbing while the consumer is ahead, so a backlog is conflated rather than traded tick by tick.
+                if (!batch.endOfDay && tickQueue.size() > 0)
+                    return;
+                conflationCache.drain(newData);
 
-                std::vector<StockTrade> trades = tradingEngine.executeTradingStrategy(lookbackWindow, cash, currentHoldings, currentProfitsLosses);
-                
-                persistTrades(trades);
+                if (!newData.empty()) {
+                    profiler.startComponent("Lookback Window");
+                    const size_t kept = std::min(lookbackWindow.size(), newData.size());
+                    lookbackWindow.erase(lookbackWindow.begin(), lookbackWindow.end() - kept);
+                    lookbackWindow.insert(lookbackWindow.end(), newData.begin(), newData.end());
+                    profiler.stopComponent("Lookback Window");
+                    profiler.countItems("Lookback Window", newData.size());
+                    riskManager.onMarketData(newData);
+                    for (const StockPrice& price : newData)
+                        analytics.onPrice(price);
+                    for (const TickSummary& summary : conflationCache.summaries())
+                        analytics.onSummary(summary);
 
-                updateHoldingsAndCash(trades, currentHoldings, currentProfitsLosses, cash, profiler);
+                    std::vector<StockTrade> trades;
+                    if (crossSectional) {
+                        crossSectional->onPrices(newData);
+                        crossSectional->evaluate();
+                        trades = crossSectional->orders(newData.back().time, cash);
+                    } else {
+                        trades = tradingEngine.executeTradingStrategy(lookbackWindow, cash, currentHoldings);
+                        profiler.countItems("TradingEngine", newData.size());
+                    }
+                    riskManager.filterOrders(trades, cash);
+                    if (crossSectional) {
+                        for (const StockTrade& trade : trades)
+                            crossSectional->onFill(trade);
+                    }
+
+                    updateHoldingsAndCash(trades, currentHoldings, cash, profiler);
+                    for (const StockTrade& trade : trades)
+                        analytics.onTrade(trade);
+                    analytics.sample(newData.back().time);
+
+                    tradeSequence += trades.size();
+                    if (!trades.empty())
+                        emit(std::move(trades));
+                }
+                if (oldestPendingNs > 0) {
+                    decisionLatency.record(pipelineClockNanoseconds() - oldestPendingNs);
+                    oldestPendingNs = 0;
+                }
+
+                if (batch.endOfDay)
+                    lookbackWindow.clear();
+
+                // Every tick up to consumedOffset has now been traded, so this is a consistent restart point.
+                if (checkpointer && (batch.endOfDay || checkpointer->due())) {
+                    ControllerState state;
+                    state.date = batch.date;
+                    state.dayComplete = batch.endOfDay;
+                    state.consumerOffset = consumedOffset;
+                    state.dayStartOffset = batch.endOfDay ? consumedOffset : dayStartOffset;
+                    state.tradeSequence = tradeSequence;
+                    state.cash = cash;
+                    state.holdings.assign(currentHoldings.begin(), currentHoldings.end());
+                    state.lookbackWindow.assign(lookbackWindow.begin(), lookbackWindow.end());
+                    state.analytics = analytics.state();
+                    checkpointer->offer(std::move(state));
+                }
+                if (batch.endOfDay) {
+                    dayStartOffset = consumedOffset;
+                    if (checkpointer) {
+                        checkpointer->flush();
+                        std::lock_guard<std::mutex> lock(tradedDaysMutex);
+                        ++tradedDays;
+                        tradedDaysChanged.notify_one();
+                    }
+                }
+            }, pipelineConfig.strategyRuntime, pipelineConfig.runtime);
+
+        uint64_t persistSequence = restored.tradeSequence;
+        bool persistFailed = false;
+        PersistStage persistStage("Persist", 1, tradeQueue, nullptr,
+            [&](std::vector<StockTrade>& trades, const PersistStage::Emit&) {
+                try {
+                    size_t stored = 0;
+                    if (persistSequence < persistedBeforeRun)
+                        stored = static_cast<size_t>(std::min<uint64_t>(trades.size(), persistedBeforeRun - persistSequence));
+                    trades.erase(trades.begin(), trades.begin() + stored);
+                    persistSequence += stored + trades.size();
+
+                    // After a failure the stored sequence stays at the last one that had no gap before it.
+                    const bool sequenced = sequencedPersistence && !persistFailed;
+                    if (pipelineConfig.persistence == TradePersistence::SQLite && !trades.empty()
+                        && !persistTrades(trades, sequenced ? static_cast<int64_t>(persistSequence) : -1)) {
+                        // Snapshots from here on would count trades that are not in the database.
+                        persistFailed = true;
+                        if (checkpointer)
+                            checkpointer->stopPersistence();
+                        return;
+                    }
+                    persistedTrades.fetch_add(trades.size(), std::memory_order_relaxed);
+                    persistedSequence.store(persistSequence);
+                    if (reactorSession.load())
+                        persistedNotifier.notify();
+                    else
+                        reportPersisted();
+                } catch (...) {
+                    if (checkpointer)
+                        checkpointer->stopPersistence();
+                    throw;
+                }
+            }, pipelineConfig.persistRuntime, pipelineConfig.runtime);
+
+        for (DayStage* stage : {&fetchStage, &parseStage, &interpolateStage, &archiveStage, &publishStage})
+            stage->start();
+        consumeStage.start();
+        tradeStage.start();
+        persistStage.start();
+
+        for (size_t i = firstDay; i < targetDates.size(); i++)
+            dateQueue.push({i - firstDay, MarketDay{targetDates[i], {}, {}}});
+        dateQueue.close();
+
+        for (DayStage* stage : {&fetchStage, &parseStage, &interpolateStage, &archiveStage, &publishStage})
+            stage->join();
+        consumeStage.join();
+        tradeStage.join();
+        persistStage.join();
+
+        double pipelineSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - pipelineStart).count();
+        std::vector<StageStats> stageStats = {fetchStage.stats(), parseStage.stats(), interpolateStage.stats(),
+                                              archiveStage.stats(), publishStage.stats(), consumeStage.stats(), tradeStage.stats(),
+                                              persistStage.stats()};
+        for (const StageStats& stage : stageStats) {
+            if (stage.wakeupLatency.count())
+                profiler.latencyHistogram(stage.name + " Wakeup (" + waitStrategyName(stage.waitStrategy) + ")")
+                    .merge(stage.wakeupLatency);
+        }
+        if (useReactor) {
+            for (const ReactorSourceStats& source : reactor.stats()) {
+                if (source.wakeupLatency.count())
+                    profiler.latencyHistogram("Reactor Wakeup (" + source.name + ")").merge(source.wakeupLatency);
+            }
+        }
+        if (checkpointer)
+            checkpointer->flush();
+
+        runStats.wallSeconds = pipelineSeconds;
+        runStats.ticksPublished = publishedTicks;
+        runStats.tradesPersisted = persistedTrades.load();
+        runStats.stages = stageStats;
+
+        if (pipelineConfig.printReport) {
+            printPipelineReport(stageStats, pipelineSeconds);
+            if (useReactor)
+                reactor.printReport();
+            if (checkpointer) {
+                std::cout << "Checkpoints written: " << checkpointer->writtenCount()
+                          << ", superseded before writing: " << checkpointer->droppedCount() << std::endl;
+            }
+            if (shardedTrader) {
+                TradeAnalytics::printReport(shardedTrader->snapshot());
+                shardedTrader->printSummary();
+            } else {
+                TradeAnalytics::printReport(analytics.snapshot());
+                riskManager.printSummary();
+                conflationCache.printSummary();
             }
         }
-        
-        int totalTrades; std::map<std::string, int> countByTicker;
-        calculateTradeStatistics(totalTrades, countByTicker);
-        std::cout << "Initial Cash: " << this->cash << std::endl;
-        std::cout << "Final Cash: " << cash << std::endl;
-        std::cout << "Change in Cash: " << cash - this->cash << std::endl;
-        std::cout << "Final P&L: " << currentProfitsLosses << std::endl;
-        for(auto [ticker, ct]: countByTicker)
-            std::cout << ticker << ": " << ct << " trades executed" << std::endl;
-        std::cout << "Total trades executed: " << totalTrades << std::endl;
 
         profiler.stopComponent("Controller");
     }
@@ -108,79 +709,77 @@ public:
  * @brief Inserts a vector of trades into the SQLite3 database stored in "trades.db". 
  *
  * @param trades The vector of StockTrade objects to insert into the database.
+ * @param tradeSequence When not negative, the number of trades persisted once these are. It is
+ *                      stored in the same transaction as the trades, so a resumed run can tell
+ *                      which of the trades it replays are already in the database.
+ * @return False if the database could not be opened or a statement failed. With a tradeSequence,
+ *         nothing is committed then.
  */
-void persistTrades(const std::vector<StockTrade>& trades) {
+bool persistTrades(const std::vector<StockTrade>& trades, int64_t tradeSequence) {
     sqlite3* db;
     int rc = sqlite3_open("trades.db", &db);
     if (rc) {
         std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_close(db);
-        return;
+        return false;
     }
 
-    const char* createTableSQL = "CREATE TABLE IF NOT EXISTS TRADES ("
-                                "ticker TEXT NOT NULL,"
-                                "time TEXT NOT NULL,"
-                                "qty INTEGER NOT NULL);";
-    rc = sqlite3_exec(db, createTableSQL, nullptr, 0, nullptr);
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_close(db);
-        return;
+    std::vector<std::string> statements = {"CREATE TABLE IF NOT EXISTS TRADES ("
+                                           "ticker TEXT NOT NULL,"
+                                           "time TEXT NOT NULL,"
+                                           "qty INTEGER NOT NULL);"};
+    if (tradeSequence >= 0) {
+        statements.push_back("CREATE TABLE IF NOT EXISTS TRADE_SEQUENCE ("
+                             "id INTEGER PRIMARY KEY CHECK (id = 0),"
+                             "persisted INTEGER NOT NULL);");
+        statements.push_back("BEGIN;");
     }
-
     for (const StockTrade& trade : trades) {
-        std::string insertSQL = "INSERT INTO TRADES (ticker, time, qty) VALUES ('" +
-                                trade.ticker + "', '" + trade.timestamp + "', " + std::to_string(trade.qty) + ");";
-        rc = sqlite3_exec(db, insertSQL.c_str(), nullptr, 0, nullptr);
+        statements.push_back("INSERT INTO TRADES (ticker, time, qty) VALUES ('" +
+                             trade.ticker + "', '" + trade.timestamp + "', " + std::to_string(trade.qty) + ");");
+    }
+    if (tradeSequence >= 0) {
+        statements.push_back("INSERT OR REPLACE INTO TRADE_SEQUENCE (id, persisted) VALUES (0, " +
+                             std::to_string(tradeSequence) + ");");
+        statements.push_back("COMMIT;");
+    }
+
+    for (const std::string& statement : statements) {
+        rc = sqlite3_exec(db, statement.c_str(), nullptr, 0, nullptr);
         if (rc != SQLITE_OK) {
             std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-            sqlite3_close(db);
-            return;
+            sqlite3_close(db); // Rolls back an open transaction
+            return false;
         }
     }
 
     sqlite3_close(db);
+    return true;
 }
+
 /**
- * @brief Query the database to calculate trade statistics.
+ * @brief Reads the trade sequence last stored by persistTrades() from "trades.db".
  *
- * @param totalTrades Reference to store the total number of trades.
- * @param tickerCounts Reference to store the count of each ticker type.
+ * @return The sequence, 0 if none was stored, or -1 if the database could not be read.
  */
-void calculateTradeStatistics(int& totalTrades, std::map<std::string, int>& tickerCounts) {
+int64_t persistedTradeSequence() {
     sqlite3* db;
-    int rc = sqlite3_open("trades.db", &db);
-    if (rc) {
+    if (sqlite3_open("trades.db", &db)) {
         std::cerr << "Can't open database: " << sqlite3_errmsg(db) << std::endl;
         sqlite3_close(db);
-        return;
+        return -1;
     }
 
-    const char* selectSQL = "SELECT ticker, COUNT(*) FROM TRADES GROUP BY ticker;";
-    sqlite3_stmt* stmt;
-    rc = sqlite3_prepare_v2(db, selectSQL, -1, &stmt, nullptr);
-    if (rc != SQLITE_OK) {
+    int64_t sequence = 0;
+    sqlite3_stmt* statement = nullptr;
+    if (sqlite3_prepare_v2(db, "SELECT persisted FROM TRADE_SEQUENCE WHERE id = 0;", -1, &statement, nullptr) == SQLITE_OK) {
+        if (sqlite3_step(statement) == SQLITE_ROW)
+            sequence = sqlite3_column_int64(statement, 0);
+    } else if (std::string(sqlite3_errmsg(db)).find("no such table") == std::string::npos) {
         std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-        sqlite3_close(db);
-        return;
-    }
-
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        const char* ticker = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-        int count = sqlite3_column_int(stmt, 1);
-        tickerCounts[std::string(ticker)] = count;
+        sequence = -1;
     }
-
-    if (rc != SQLITE_DONE) {
-        std::cerr << "SQL error: " << sqlite3_errmsg(db) << std::endl;
-    }
-
-    sqlite3_finalize(stmt);
+    sqlite3_finalize(statement);
     sqlite3_close(db);
-
-    totalTrades = 0;
-    for (const auto& entry : tickerCounts) {
-        totalTrades += entry.second;
-    }
-}
\ No newline at end of file
+    return sequence;
+}
@@ -0,0 +1,289 @@
+#include "cross_sectional.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <immintrin.h>
+
+#include "trading_engine.h"
+
+namespace {
+const size_t kLaneMultiple = 8; // One AVX-512 register of doubles
+const uint64_t kResyncWraps = 64; // Window wraps between rebuilds of the rolling sums
+
+struct KernelArgs {
+    const double* price;
+    double* sum;
+    const double* scale;
+    const double* position;
+    const double* maxPosition;
+    double* oldest;   // The history row the current prices replace
+    uint64_t* mask;
+    size_t lanes;
+    bool warm;
+};
+
+// Each lane computes sum = (sum - oldest) + price and
+// signal = price > 0 && price < sum * scale && position < maxPosition, where scale folds the
+// division by the window into the threshold. Every kernel must keep exactly this sequence
+// of operations so the levels agree bit for bit.
+
+void evaluateScalar(const KernelArgs& a) {
+    for (size_t i = 0; i < a.lanes; i++) {
+        const double price = a.price[i];
+        const double sum = (a.sum[i] - a.oldest[i]) + price;
+        a.sum[i] = sum;
+        a.oldest[i] = price;
+        if (a.warm) {
+            const double limit = sum * a.scale[i];
+            const bool signal = (price > 0.0) & (price < limit) & (a.position[i] < a.maxPosition[i]);
+            a.mask[i >> 6] |= static_cast<uint64_t>(signal) << (i & 63);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void evaluateAvx2(const KernelArgs& a) {
+    const __m256d zero = _mm256_setzero_pd();
+    for (size_t i = 0; i < a.lanes; i += 4) {
+        const __m256d price = _mm256_load_pd(a.price + i);
+        const __m256d sum = _mm256_add_pd(_mm256_sub_pd(_mm256_load_pd(a.sum + i), _mm256_load_pd(a.oldest + i)), price);
+        _mm256_store_pd(a.sum + i, sum);
+        _mm256_store_pd(a.oldest + i, price);
+        if (a.warm) {
+            const __m256d limit = _mm256_mul_pd(sum, _mm256_load_pd(a.scale + i));
+            __m256d signal = _mm256_cmp_pd(price, zero, _CMP_GT_OQ);
+            signal = _mm256_and_pd(signal, _mm256_cmp_pd(price, limit, _CMP_LT_OQ));
+            signal = _mm256_and_pd(signal, _mm256_cmp_pd(_mm256_load_pd(a.position + i),
+                                                         _mm256_load_pd(a.maxPosition + i), _CMP_LT_OQ));
+            a.mask[i >> 6] |= static_cast<uint64_t>(_mm256_movemask_pd(signal)) << (i & 63);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+void evaluateAvx512(const KernelArgs& a) {
+    const __m512d zero = _mm512_setzero_pd();
+    for (size_t i = 0; i < a.lanes; i += 8) {
+        const __m512d price = _mm512_load_pd(a.price + i);
+        const __m512d sum = _mm512_add_pd(_mm512_sub_pd(_mm512_load_pd(a.sum + i), _mm512_load_pd(a.oldest + i)), price);
+        _mm512_store_pd(a.sum + i, sum);
+        _mm512_store_pd(a.oldest + i, price);
+        if (a.warm) {
+            const __m512d limit = _mm512_mul_pd(sum, _mm512_load_pd(a.scale + i));
+            __mmask8 signal = _mm512_cmp_pd_mask(price, zero, _CMP_GT_OQ);
+            signal &= _mm512_cmp_pd_mask(price, limit, _CMP_LT_OQ);
+            signal &= _mm512_cmp_pd_mask(_mm512_load_pd(a.position + i), _mm512_load_pd(a.maxPosition + i), _CMP_LT_OQ);
+            a.mask[i >> 6] |= static_cast<uint64_t>(signal) << (i & 63);
+        }
+    }
+}
+
+bool supported(SimdLevel level) {
+    return level <= detectSimdLevel();
+}
+}
+
+SimdLevel detectSimdLevel() {
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+    return SimdLevel::Scalar;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+CrossSectionalStrategy::AlignedDoubles CrossSectionalStrategy::allocate(size_t count, double value) {
+    AlignedDoubles buffer(static_cast<double*>(std::aligned_alloc(64, count * sizeof(double))));
+    std::fill(buffer.get(), buffer.get() + count, value);
+    return buffer;
+}
+
+CrossSectionalStrategy::CrossSectionalStrategy(const std::vector<std::string>& symbols,
+                                               const CrossSectionalConfig& config, Profiler& profiler,
+                                               SimdLevel level)
+    : config_(config),
+      symbols_(symbols),
+      lanes_((symbols.size() + kLaneMultiple - 1) / kLaneMultiple * kLaneMultiple),
+      head_(0),
+      snapshots_(0),
+      level_(SimdLevel::Scalar),
+      latency_(profiler.latencyHistogram("Cross-Sectional Evaluate")) {
+    config_.window = std::max<size_t>(config_.window, 1);
+    lanes_ = std::max(lanes_, kLaneMultiple);
+
+    // Padding lanes keep a zero price, which never signals.
+    price_ = allocate(lanes_, 0.0);
+    sum_ = allocate(lanes_, 0.0);
+    scale_ = allocate(lanes_, (1.0 - config_.entryThreshold) / static_cast<double>(config_.window));
+    position_ = allocate(lanes_, 0.0);
+    maxPosition_ = allocate(lanes_, config_.maxPosition);
+    history_ = allocate(lanes_ * config_.window, 0.0);
+    mask_.assign((lanes_ + 63) / 64, 0);
+
+    for (uint32_t i = 0; i < symbols_.size(); i++)
+        symbolIndex_.emplace(symbols_[i], i);
+    setSimdLevel(level);
+}
+
+void CrossSectionalStrategy::setSimdLevel(SimdLevel level) {
+    level_ = supported(level) ? level : detectSimdLevel();
+}
+
+void CrossSectionalStrategy::onPrices(const std::vector<StockPrice>& prices) {
+    for (const StockPrice& price : prices) {
+        auto it = symbolIndex_.find(price.ticker);
+        if (it != symbolIndex_.end())
+            price_[it->second] = price.price;
+    }
+}
+
+void CrossSectionalStrategy::resyncSums() {
+    std::fill(sum_.get(), sum_.get() + lanes_, 0.0);
+    for (size_t row = 0; row < config_.window; row++) {
+        const double* prices = history_.get() + row * lanes_;
+        for (size_t i = 0; i < lanes_; i++)
+            sum_[i] += prices[i];
+    }
+}
+
+const std::vector<uint64_t>& CrossSectionalStrategy::evaluate() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::fill(mask_.begin(), mask_.end(), 0);
+    KernelArgs args{price_.get(), sum_.get(), scale_.get(), position_.get(), maxPosition_.get(),
+                    history_.get() + head_ * lanes_, mask_.data(), lanes_, snapshots_ + 1 >= config_.window};
+    switch (level_) {
+        case SimdLevel::AVX512: evaluateAvx512(args); break;
+        case SimdLevel::AVX2: evaluateAvx2(args); break;
+        default: evaluateScalar(args); break;
+    }
+
+    ++snapshots_;
+    head_ = (head_ + 1) % config_.window;
+    if (snapshots_ % (config_.window * kResyncWraps) == 0)
+        resyncSums();
+
+    latency_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    return mask_;
+}
+
+std::vector<StockTrade> CrossSectionalStrategy::orders(const std::string& time, double cash) const {
+    std::vector<StockTrade> trades;
+    for (size_t word = 0; word < mask_.size(); word++) {
+        for (uint64_t bits = mask_[word]; bits; bits &= bits - 1) {
+            const size_t index = word * 64 + __builtin_ctzll(bits);
+            const double price = price_[index];
+            const double quantity = std::min(cash / price, config_.orderQty);
+            cash -= quantity * price;
+            trades.push_back({symbols_[index], time, static_cast<size_t>(quantity), price});
+        }
+    }
+    return trades;
+}
+
+void CrossSectionalStrategy::onFill(const StockTrade& trade) {
+    auto it = symbolIndex_.find(trade.ticker);
+    if (it != symbolIndex_.end())
+        position_[it->second] += static_cast<double>(trade.qty);
+}
+
+void CrossSectionalStrategy::setPosition(const std::string& ticker, double quantity) {
+    auto it = symbolIndex_.find(ticker);
+    if (it != symbolIndex_.end())
+        position_[it->second] = quantity;
+}
+
+size_t CrossSectionalStrategy::signalCount() const {
+    size_t count = 0;
+    for (uint64_t word : mask_)
+        count += __builtin_popcountll(word);
+    return count;
+}
+
+bool benchmarkCrossSectional(const std::vector<size_t>& universeSizes, size_t snapshots, Profiler& profiler) {
+    const SimdLevel widest = detectSimdLevel();
+    std::vector<SimdLevel> levels;
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= widest)
+            levels.push_back(level);
+    }
+
+    TradingEngine tradingEngine(profiler);
+    bool consistent = true;
+    for (size_t symbolCount : universeSizes) {
+        std::vector<std::string> symbols;
+        for (size_t i = 0; i < symbolCount; i++)
+            symbols.push_back("SYM" + std::to_string(i));
+
+        std::vector<std::unique_ptr<CrossSectionalStrategy>> strategies;
+        std::vector<LatencyHistogram> latencies(levels.size());
+        for (SimdLevel level : levels)
+            strategies.push_back(std::make_unique<CrossSectionalStrategy>(symbols, CrossSectionalConfig(), profiler, level));
+
+        std::deque<StockPrice> lookbackWindow;
+        for (const std::string& symbol : symbols)
+            lookbackWindow.push_back(StockPrice(symbol, "0", 100.0));
+        LatencyHistogram baseline;
+
+        std::mt19937_64 rng(42);
+        std::normal_distribution<double> step(0.0, 0.001);
+        std::vector<double> prices(symbolCount, 100.0);
+        size_t mismatches = 0;
+        size_t signals = 0;
+
+        for (size_t snapshot = 0; snapshot < snapshots; snapshot++) {
+            for (size_t i = 0; i < symbolCount; i++) {
+                prices[i] *= 1.0 + step(rng);
+                lookbackWindow[i].price = prices[i];
+            }
+
+            for (size_t l = 0; l < levels.size(); l++) {
+                for (size_t i = 0; i < symbolCount; i++)
+                    strategies[l]->setPrice(i, prices[i]);
+                auto start = std::chrono::steady_clock::now();
+                strategies[l]->evaluate();
+                latencies[l].record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::string> stocksToBuy = tradingEngine.movingAverageCrossover(lookbackWindow);
+            baseline.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+
+            const CrossSectionalStrategy& reference = *strategies.front();
+            signals += reference.signalCount();
+            for (size_t l = 1; l < levels.size(); l++) {
+                if (strategies[l]->mask() != reference.mask()
+                    || std::memcmp(strategies[l]->sums(), reference.sums(), symbolCount * sizeof(double)) != 0)
+                    ++mismatches;
+            }
+        }
+
+        std::cout << "Cross-sectional signals, " << symbolCount << " symbols, " << snapshots << " snapshots, "
+                  << signals << " signals" << std::endl;
+        std::cout << "  movingAverageCrossover (deque): mean " << baseline.mean() << " ns, p50 "
+                  << baseline.percentile(50) << " ns, p99 " << baseline.percentile(99) << " ns" << std::endl;
+        for (size_t l = 0; l < levels.size(); l++) {
+            std::cout << "  " << simdLevelName(levels[l]) << ": mean " << latencies[l].mean() << " ns, p50 "
+                      << latencies[l].percentile(50) << " ns, p99 " << latencies[l].percentile(99) << " ns, "
+                      << latencies[l].mean() / symbolCount << " ns/symbol, "
+                      << latencies.front().mean() / latencies[l].mean() << "x scalar" << std::endl;
+        }
+        std::cout << "  Snapshots differing from scalar: " << mismatches << std::endl;
+        consistent = consistent && mismatches == 0;
+    }
+    return consistent;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Model/stock_price.h"
+#include "../Model/stock_trade.h"
+#include "../Profiler/performance_profiler.h"
+
+/**
+ * @enum SimdLevel
+ * @brief The instruction set a CrossSectionalStrategy kernel runs on.
+ */
+enum class SimdLevel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief Returns the widest SimdLevel the running CPU supports.
+ */
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * @struct CrossSectionalConfig
+ * @brief Parameters of the cross-sectional mean-reversion signal.
+ */
+struct CrossSectionalConfig {
+    size_t window = 30;           // Snapshots in each symbol's moving average
+    double entryThreshold = 0.0;  // Buy when price < mean * (1 - entryThreshold)
+    double maxPosition = 10000.0; // Symbols holding at least this many shares are not bought
+    double orderQty = 1000.0;     // Largest order per signal, in shares
+};
+
+/**
+ * @class CrossSectionalStrategy
+ * @brief Evaluates a moving average signal for the whole symbol universe in one pass.
+ *
+ * Per-symbol state (latest price, the last window prices, their rolling sum, threshold and
+ * position) is kept as 64-byte aligned structure-of-arrays indexed by a dense symbol index,
+ * padded to a multiple of eight lanes. Each evaluate() appends the latest price of every
+ * symbol to its window and computes a buy signal per symbol, returned as a bitmask with one
+ * bit per symbol instead of a list of tickers.
+ *
+ * The kernel is dispatched at runtime to AVX-512, AVX2 or a scalar loop. Every lane applies
+ * the same IEEE operations in the same order, and no step can be fused into an FMA, so all
+ * levels produce bit-identical sums and masks. Rolling sums are periodically rebuilt from the
+ * window, which bounds their rounding drift.
+ */
+class CrossSectionalStrategy {
+private:
+    struct FreeDeleter {
+        void operator()(double* p) const { std::free(p); }
+    };
+    using AlignedDoubles = std::unique_ptr<double[], FreeDeleter>;
+
+    CrossSectionalConfig config_;
+    std::vector<std::string> symbols_;
+    std::unordered_map<std::string, uint32_t> symbolIndex_;
+    size_t lanes_;
+
+    AlignedDoubles price_;
+    AlignedDoubles sum_;
+    AlignedDoubles scale_;       // (1 - entryThreshold) / window, per symbol
+    AlignedDoubles position_;
+    AlignedDoubles maxPosition_;
+    AlignedDoubles history_;     // window rows of lanes_ prices; row head_ is the oldest
+    std::vector<uint64_t> mask_;
+    size_t head_;
+    uint64_t snapshots_;
+
+    SimdLevel level_;
+    LatencyHistogram& latency_;
+
+    static AlignedDoubles allocate(size_t count, double value);
+    void resyncSums();
+
+public:
+    /**
+     * @brief Constructor to initialize the CrossSectionalStrategy.
+     * @param symbols The universe; bit i of the mask refers to symbols[i].
+     * @param config The signal parameters.
+     * @param profiler The profiler object that receives the evaluation latency.
+     * @param level The kernel to use; defaults to the widest the CPU supports.
+     */
+    CrossSectionalStrategy(const std::vector<std::string>& symbols, const CrossSectionalConfig& config,
+                           Profiler& profiler, SimdLevel level = detectSimdLevel());
+
+    /**
+     * @brief Records the newest price of each ticker; unknown tickers are ignored.
+     */
+    void onPrices(const std::vector<StockPrice>& prices);
+
+    /**
+     * @brief Sets the price of a symbol by its index.
+     */
+    void setPrice(size_t index, double price) { price_[index] = price; }
+
+    /**
+     * @brief Advances every symbol's window by the current prices and computes the buy mask.
+     *
+     * A symbol signals when its window is full, its price is positive and below
+     * mean * (1 - entryThreshold), and its position is below maxPosition.
+     *
+     * @return One bit per symbol, 64 symbols per word.
+     */
+    const std::vector<uint64_t>& evaluate();
+
+    /**
+     * @brief Converts the last mask into orders, sized like TradingEngine::executeTradingStrategy.
+     * @param time The market time stamped on the orders.
+     * @param cash The cash available; each order takes min(orderQty, cash / price) shares of what is left.
+     */
+    std::vector<StockTrade> orders(const std::string& time, double cash) const;
+
+    /**
+     * @brief Applies an executed trade to the symbol's position.
+     */
+    void onFill(const StockTrade& trade);
+
+    /**
+     * @brief Sets a symbol's position, e.g. to the holdings restored after a restart.
+     */
+    void setPosition(const std::string& ticker, double quantity);
+
+    const std::vector<uint64_t>& mask() const { return mask_; }
+    size_t signalCount() const;
+    size_t symbolCount() const { return symbols_.size(); }
+    const double* sums() const { return sum_.get(); }
+
+    SimdLevel simdLevel() const { return level_; }
+
+    /**
+     * @brief Selects the kernel; levels the CPU does not support fall back to the widest it does.
+     */
+    void setSimdLevel(SimdLevel level);
+};
+
+/**
+ * @brief Times the scalar, AVX2 and AVX-512 kernels against the deque-based strategy.
+ *
+ * For each universe size the same random-walk prices are fed to every supported kernel, the
+ * masks and rolling sums are checked for bitwise equality after every snapshot, and the
+ * per-snapshot latency is printed next to TradingEngine::movingAverageCrossover over a
+ * window holding one price per symbol.
+ *
+ * @param universeSizes The symbol counts to benchmark.
+ * @param snapshots The number of snapshots evaluated per kernel.
+ * @param profiler The profiler object to be used for performance measurement.
+ * @return True if every kernel matched the scalar kernel bit for bit.
+ */
+bool benchmarkCrossSectional(const std::vector<size_t>& universeSizes, size_t snapshots, Profiler& profiler);
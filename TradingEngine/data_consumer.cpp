@@ -1,11 +1,17 @@
+#pragma once
+
 #include <string>
 #include <vector>
 #include <librdkafka/rdkafkacpp.h>
 #include <thread>
 #include <algorithm>
+#include <limits>
 
 #include "../Model/stock_price.h"
+#include "../Model/util.h"
 #include "../Profiler/performance_profiler.h"
+#include "../Pipeline/wait_strategy.h"
+#include "../Pipeline/event_reactor.h"
 
 /**
  * @class KafkaConsumer
@@ -20,16 +26,40 @@ private:
     RdKafka::Conf* conf;
     RdKafka::Consumer* consumer;
     RdKafka::Topic* topic;
-    const uint32_t partition = RdKafka::Topic::PARTITION_UA;
+    RdKafka::Queue* queue = nullptr;
+    const int32_t partition;
+    int64_t nextOffset = 0;
+    bool endOfDay = false;
+    WaitStrategy waitStrategy = WaitStrategy::Blocking;
     Profiler& profiler;
+
+    /**
+     * @brief Appends a tick message that falls inside [startTime, endTime] and advances the offset.
+     * @return True if the message is the end-of-day marker.
+     */
+    bool handleMessage(RdKafka::Message& msg, int64_t startTime, int64_t endTime, std::vector<StockPrice>& out) {
+        nextOffset = msg.offset() + 1;
+        if (msg.key() && *msg.key() == endOfDayKey) {
+            endOfDay = true;
+            return true;
+        }
+        int64_t timestamp = msg.timestamp().timestamp;
+        if (timestamp >= startTime && timestamp <= endTime) {
+            std::string key = reinterpret_cast<const char*>(msg.key());
+            double price = std::stod(static_cast<const char*>(msg.payload()));
+            out.push_back({key, std::to_string(timestamp), price});
+        }
+        return false;
+    }
 public:
     /**
      * @brief Constructor to initialize the KafkaConsumer.
      * @param brokerAddr The address of the Kafka broker to connect.
      * @param topicName The name of the topic to consume messages from.
+     * @param partition The partition to consume; sharded consumers each own one.
      */
-    KafkaConsumer(Profiler& profiler)
-        : profiler(profiler) {
+    KafkaConsumer(Profiler& profiler, int32_t partition = RdKafka::Topic::PARTITION_UA)
+        : partition(partition), profiler(profiler) {
         this->profiler.startComponent("Data Consumer");
         conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
         conf->set("bootstrap.servers", brokerAddr, errstr);
@@ -49,40 +79,113 @@ public:
      * @brief Destructor to clean up resources.
      */
     ~KafkaConsumer() {
+        disableEventNotification();
         delete topic;
         delete consumer;
         delete conf;
     }
 
+    /**
+     * @brief Whether the end-of-day marker of the current trading day has been consumed.
+     */
+    bool endOfDayReached() const {
+        return endOfDay;
+    }
+
+    /**
+     * @brief Clears the end-of-day flag so the next trading day can be consumed.
+     */
+    void startNextDay() {
+        endOfDay = false;
+    }
+
+    /**
+     * @brief The offset of the next message to consume.
+     */
+    int64_t offset() const {
+        return nextOffset;
+    }
+
+    /**
+     * @brief Moves the consumer to an offset, e.g. the one recorded in a restart snapshot.
+     */
+    void seek(int64_t offset) {
+        nextOffset = offset;
+    }
+
+    /**
+     * @brief Queries the broker for the offset the next message published to the partition will get.
+     * @return The high watermark, or -1 if the broker could not be queried.
+     */
+    int64_t endOffset() {
+        int64_t low = 0;
+        int64_t high = -1;
+        RdKafka::ErrorCode err = consumer->query_watermark_offsets(topicName, std::max<int32_t>(partition, 0),
+                                                                   &low, &high, 5000);
+        if (err != RdKafka::ERR_NO_ERROR) {
+            std::cerr << "Failed to query watermark offsets: " << RdKafka::err2str(err) << std::endl;
+            return -1;
+        }
+        return high;
+    }
+
+    /**
+     * @brief Selects how the consumer waits for messages.
+     *
+     * Blocking waits inside librdkafka with a 10ms timeout. The spinning strategies poll with
+     * a zero timeout and back off in user space, avoiding the scheduler wakeup on arrival.
+     */
+    void setWaitStrategy(WaitStrategy strategy) {
+        waitStrategy = strategy;
+    }
+
     /**
      * @brief Function to consume stock price messages from Kafka within the specified lookback period.
+     *
+     * Consumption resumes from the offset after the last message returned, and stops early at
+     * the end-of-day marker published after each trading day. It also returns as soon as the
+     * partition goes idle after at least one tick was taken, or once maxMessages were read, so
+     * ticks reach the strategy while the day is still being published.
      * @param lookbackPeriod The time period (in milliseconds) to look back for stock prices.
+     * @param maxMessages Upper bound on the messages read in one call.
      * @return A vector of StockPrice containing the stock prices within the lookback period.
      */
-    std::vector<StockPrice> consumeMessages(int lookbackPeriod) {
+    std::vector<StockPrice> consumeMessages(int lookbackPeriod,
+                                            size_t maxMessages = std::numeric_limits<size_t>::max()) {
         this->profiler.startComponent("Data Consumer");
         std::vector<StockPrice> lookbackWindow;
         int64_t endTime = std::chrono::duration_cast<std::chrono::milliseconds>(
             std::chrono::system_clock::now().time_since_epoch()).count();
 
         int64_t startTime = endTime - lookbackPeriod;
-        RdKafka::ErrorCode err = consumer->start(topic, partition, (int64_t)0);
+        RdKafka::ErrorCode err = consumer->start(topic, partition, nextOffset);
         if (err != RdKafka::ERR_NO_ERROR) {
             std::cerr << "Failed to assign partition: " << RdKafka::err2str(err) << std::endl;
             return lookbackWindow;
         }
 
         RdKafka::Message* msg = nullptr;
-        while (true) {
-            msg = consumer->consume(topic, partition, 10); // 10ms timeout
+        const int timeoutMs = waitStrategy == WaitStrategy::Blocking ? 10 : 0;
+        uint32_t idlePolls = 0;
+        size_t taken = 0;
+        while (taken < maxMessages) {
+            msg = consumer->consume(topic, partition, timeoutMs);
+            if (msg && msg->err() == RdKafka::ERR__TIMED_OUT) {
+                delete msg;
+                // An idle partition ends the batch once it holds ticks; otherwise keep waiting for the first one.
+                if (!lookbackWindow.empty())
+                    break;
+                if (timeoutMs == 0)
+                    idleBackoff(waitStrategy, idlePolls++);
+                continue;
+            }
+            idlePolls = 0;
+            ++taken;
             if (msg && msg->err() == RdKafka::ERR_NO_ERROR) {
-                int64_t timestamp = msg->timestamp().timestamp;
-                if (timestamp >= startTime && timestamp <= endTime) {
-                    std::string key = reinterpret_cast<const char*>(msg->key());
-                    double price = std::stod(static_cast<const char*>(msg->payload()));
-                    lookbackWindow.push_back({key, std::to_string(timestamp), price});
-                }
+                bool endOfDayMarker = handleMessage(*msg, startTime, endTime, lookbackWindow);
                 delete msg;
+                if (endOfDayMarker)
+                    break;
             } else if (msg && msg->err() == RdKafka::ERR__PARTITION_EOF) {
                 delete msg;
                 break;
@@ -96,4 +199,78 @@ public:
         this->profiler.stopComponent("Data Consumer");
         return lookbackWindow;
     }
+
+    /**
+     * @brief Starts the partition on a dedicated queue that signals the notifier when messages arrive.
+     *
+     * librdkafka writes to the notifier's eventfd whenever the queue goes from empty to
+     * non-empty, so an EventReactor can wait for market data instead of polling with timeouts.
+     * Messages are then read with pollMessages().
+     * @return False if the partition could not be started; the consumer keeps polling.
+     */
+    bool enableEventNotification(EventNotifier& notifier) {
+        static const uint64_t signal = 1; // eventfd takes 8-byte writes
+        queue = RdKafka::Queue::create(consumer);
+        RdKafka::ErrorCode err = queue ? consumer->start(topic, partition, nextOffset, queue) : RdKafka::ERR__FAIL;
+        if (err != RdKafka::ERR_NO_ERROR) {
+            std::cerr << "Failed to assign partition: " << RdKafka::err2str(err) << std::endl;
+            delete queue;
+            queue = nullptr;
+            return false;
+        }
+        queue->io_event_enable(notifier.fd(), &signal, sizeof(signal));
+        return true;
+    }
+
+    /**
+     * @brief Stops the partition started by enableEventNotification().
+     */
+    void disableEventNotification() {
+        if (!queue)
+            return;
+        queue->io_event_enable(-1, nullptr, 0);
+        consumer->stop(topic, partition);
+        delete queue;
+        queue = nullptr;
+    }
+
+    /**
+     * @brief Reads up to maxMessages queued messages without waiting.
+     *
+     * Stops early at the end-of-day marker or once the queue is empty; an empty queue is not
+     * the end of the stream, and the notifier signals again when the next message arrives.
+     * @param lookbackPeriod The time period (in milliseconds) to look back for stock prices.
+     * @param out[out] The ticks within the lookback period are appended to it.
+     * @param maxMessages Upper bound on the messages read in one call.
+     * @return The number of messages read, counting the end-of-day marker and filtered ticks.
+     */
+    size_t pollMessages(int lookbackPeriod, std::vector<StockPrice>& out, size_t maxMessages) {
+        if (!queue)
+            return 0;
+        int64_t endTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        int64_t startTime = endTime - lookbackPeriod;
+
+        size_t taken = 0;
+        while (taken < maxMessages) {
+            RdKafka::Message* msg = consumer->consume(queue, 0);
+            if (!msg)
+                break;
+            if (msg->err() == RdKafka::ERR__TIMED_OUT || msg->err() == RdKafka::ERR__PARTITION_EOF) {
+                delete msg;
+                break;
+            }
+            ++taken;
+            if (msg->err() != RdKafka::ERR_NO_ERROR) {
+                std::cerr << "Failed to consume message: " << msg->errstr() << std::endl;
+                delete msg;
+                continue;
+            }
+            bool endOfDayMarker = handleMessage(*msg, startTime, endTime, out);
+            delete msg;
+            if (endOfDayMarker)
+                break;
+        }
+        return taken;
+    }
 };
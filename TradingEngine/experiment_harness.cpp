@@ -0,0 +1,582 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../Profiler/performance_profiler.h"
+#include "../MarketData/tick_archive.cpp"
+#include "controller.cpp"
+#include "trading_engine.h"
+#include "risk_manager.h"
+#include "trade_analytics.h"
+#include "conflation_cache.h"
+
+/**
+ * @struct ExperimentSetup
+ * @brief Everything a variant may change about one run of the pipeline.
+ */
+struct ExperimentSetup {
+    PipelineConfig pipeline;   // pipeline.sharding.conflationPolicy also configures the single trade stage
+    int lookbackPeriod = 30000;
+};
+
+/**
+ * @struct ExperimentOption
+ * @brief One named implementation choice of a dimension and how it changes the setup.
+ */
+struct ExperimentOption {
+    std::string name;
+    std::function<void(ExperimentSetup&)> apply;
+    // Given a variant's final setup, returns why the option behaves like its dimension's baseline there;
+    // empty if it takes effect. Baselines leave it unset.
+    std::function<std::string(const ExperimentSetup&)> inertIn = nullptr;
+};
+
+/**
+ * @struct ExperimentDimension
+ * @brief An axis of the variant matrix; its first option is the baseline.
+ */
+struct ExperimentDimension {
+    std::string name;
+    std::string description;
+    std::vector<ExperimentOption> options;
+};
+
+/**
+ * @brief Returns every dimension the experiment harness can vary.
+ */
+inline std::vector<ExperimentDimension> experimentDimensions() {
+    auto waitStrategy = [](WaitStrategy strategy) {
+        return [strategy](ExperimentSetup& setup) {
+            setup.pipeline.consumeRuntime.waitStrategy = strategy;
+            setup.pipeline.strategyRuntime.waitStrategy = strategy;
+        };
+    };
+    auto shards = [](size_t count) {
+        return [count](ExperimentSetup& setup) { setup.pipeline.sharding.shards = count; };
+    };
+    auto parseThreads = [](size_t count) {
+        return [count](ExperimentSetup& setup) { setup.pipeline.parseParallelism = count; };
+    };
+    auto conflation = [](ConflationPolicy policy) {
+        return [policy](ExperimentSetup& setup) { setup.pipeline.sharding.conflationPolicy = policy; };
+    };
+    auto crossSectionalInert = [](const ExperimentSetup& setup) {
+        return setup.pipeline.sharding.shards > 1 ? std::string("the shards always run the TradingEngine strategy")
+                                                  : std::string();
+    };
+    auto reactorInert = [](const ExperimentSetup& setup) {
+        if (setup.pipeline.sharding.shards > 1)
+            return std::string("the shards consume without the reactor");
+        if (setup.pipeline.consumeRuntime.waitStrategy != WaitStrategy::Blocking)
+            return std::string("only a blocking consumer waits in the reactor");
+        return std::string();
+    };
+    // ConflateOHLC is not offered: the strategy sees the same ticks as under ConflateLatest.
+    return {
+        {"window", "Lookback window layout: the TradingEngine deque, or the cross-sectional structure-of-arrays",
+         {{"deque", [](ExperimentSetup& setup) { setup.pipeline.crossSectional = false; }},
+          {"soa", [](ExperimentSetup& setup) { setup.pipeline.crossSectional = true; }, crossSectionalInert}}},
+        {"persistence", "Trade persistence: SQLite inserts, or counting and dropping the trades",
+         {{"sqlite", [](ExperimentSetup& setup) { setup.pipeline.persistence = TradePersistence::SQLite; }},
+          {"discard", [](ExperimentSetup& setup) { setup.pipeline.persistence = TradePersistence::Discard; }}}},
+        {"transport", "Market data transport between the publish and consume stages",
+         {{"in-process", [](ExperimentSetup& setup) { setup.pipeline.transport = MarketDataTransport::InProcess; }},
+          {"kafka", [](ExperimentSetup& setup) { setup.pipeline.transport = MarketDataTransport::Kafka; }}}},
+        {"shards", "Symbol-owning consume and trade threads",
+         {{"1", shards(1)}, {"2", shards(2)}, {"4", shards(4)}, {"8", shards(8)}}},
+        {"parse-threads", "Workers decoding archived days",
+         {{"2", parseThreads(2)}, {"1", parseThreads(1)}, {"4", parseThreads(4)}}},
+        {"wait", "Wait strategy of the consume and trade stages",
+         {{"blocking", waitStrategy(WaitStrategy::Blocking)},
+          {"spin-then-yield", waitStrategy(WaitStrategy::SpinThenYield)},
+          {"busy-spin", waitStrategy(WaitStrategy::BusySpin)}}},
+        {"reactor", "Whether a blocking single-shard consumer waits in the epoll reactor",
+         {{"on", [](ExperimentSetup& setup) { setup.pipeline.eventReactor = true; }},
+          {"off", [](ExperimentSetup& setup) { setup.pipeline.eventReactor = false; }, reactorInert}}},
+        {"memory", "Page allocation: faulted in on demand, or locked and prefaulted with mlockall",
+         {{"default", [](ExperimentSetup& setup) { setup.pipeline.runtime.lockMemory = false; }},
+          {"locked", [](ExperimentSetup& setup) { setup.pipeline.runtime.lockMemory = true; }}}},
+        {"conflation", "Policy of the conflation cache between the consumer and the strategy",
+         {{"latest", conflation(ConflationPolicy::ConflateLatest)},
+          {"all", conflation(ConflationPolicy::DeliverAll)}}},
+    };
+}
+
+/**
+ * @struct ExperimentConfig
+ * @brief Repetitions and output of an experiment.
+ */
+struct ExperimentConfig {
+    size_t repetitions = 5;
+    size_t warmupRuns = 1;     // Unrecorded runs of every variant before the measured ones
+    std::string csvPath;       // Raw per-run results are written here unless empty
+    bool hardwareCounters = false; // Attribute hardware counters to each profiled component of every run
+};
+
+/**
+ * @struct ExperimentSample
+ * @brief The measurements of one run of one variant.
+ */
+struct ExperimentSample {
+    double wallSeconds = 0.0;
+    uint64_t ticks = 0;
+    uint64_t trades = 0;
+    double ticksPerSecond = 0.0;
+    double decisionP50Ns = 0.0;   // Tick To Decision percentiles; 0 when no single trade stage decided
+    double decisionP99Ns = 0.0;
+    std::unordered_map<std::string, double> componentSeconds;
+    std::unordered_map<std::string, PerfCounterValues> componentCounters; // Empty without hardware counters
+};
+
+/**
+ * @struct ExperimentVariant
+ * @brief One cell of the variant matrix and the samples recorded for it.
+ */
+struct ExperimentVariant {
+    std::string name;
+    ExperimentSetup setup;
+    std::vector<ExperimentSample> samples;
+};
+
+/**
+ * @struct SampleSummary
+ * @brief Mean, sample standard deviation and 95% confidence half-width of a measurement.
+ */
+struct SampleSummary {
+    size_t count = 0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double halfWidth = 0.0;
+};
+
+/**
+ * @brief Two-sided 95% critical value of Student's t distribution.
+ */
+inline double studentT95(double degreesOfFreedom) {
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degreesOfFreedom < 1.0)
+        return table[0];
+    if (degreesOfFreedom <= 30.0)
+        return table[static_cast<size_t>(degreesOfFreedom) - 1];
+    // Approaches the normal quantile; within 0.005 of the exact value for any larger df.
+    return 1.960 + 2.46 / degreesOfFreedom;
+}
+
+inline SampleSummary summarize(const std::vector<double>& values) {
+    SampleSummary summary;
+    summary.count = values.size();
+    if (values.empty())
+        return summary;
+    for (double value : values)
+        summary.mean += value;
+    summary.mean /= values.size();
+    if (values.size() < 2)
+        return summary;
+    double squares = 0.0;
+    for (double value : values)
+        squares += (value - summary.mean) * (value - summary.mean);
+    summary.stddev = std::sqrt(squares / (values.size() - 1));
+    summary.halfWidth = studentT95(values.size() - 1) * summary.stddev / std::sqrt(static_cast<double>(values.size()));
+    return summary;
+}
+
+/**
+ * @brief Welch's t-test at the 95% level; false when either side has fewer than two samples.
+ */
+inline bool significantlyDifferent(const SampleSummary& a, const SampleSummary& b) {
+    if (a.count < 2 || b.count < 2)
+        return false;
+    const double va = a.stddev * a.stddev / a.count;
+    const double vb = b.stddev * b.stddev / b.count;
+    if (va + vb == 0.0)
+        return a.mean != b.mean;
+    const double t = std::abs(a.mean - b.mean) / std::sqrt(va + vb);
+    const double df = (va + vb) * (va + vb) / (va * va / (a.count - 1) + vb * vb / (b.count - 1));
+    return t > studentT95(df);
+}
+
+/**
+ * @class ExperimentHarness
+ * @brief Replays one recorded workload through the full pipeline under a matrix of variants.
+ *
+ * The workload is every day of a tick archive. Variants are the cartesian product of the
+ * options selected per dimension, with the dimensions that are not selected left at the
+ * base configuration. Each run builds a fresh Profiler, strategy, risk gate, analytics and
+ * conflation cache, so runs share nothing but the archive mapping and the page cache.
+ * Repetitions are interleaved across variants (all variants once, then all again), so drift
+ * in machine state, such as a growing trades.db or thermal throttling, is spread over every
+ * variant instead of biasing the last one.
+ *
+ * The report compares each variant against the first, the baseline: throughput in published
+ * ticks per second and the p50 and p99 of the tick to decision latency as mean and 95%
+ * Student-t confidence interval over the repetitions, with differences marked where Welch's
+ * t-test finds them significant. Sharded runs decide on their shard threads and report no
+ * decision latency. The report then breaks each variant's run down by profiler
+ * component and pipeline stage busy time, in nanoseconds per published tick.
+ */
+class ExperimentHarness {
+private:
+    const TickArchiveReader& archive;
+    std::vector<std::string> symbols;
+    std::vector<std::string> dates;
+    ExperimentSetup base;
+    ExperimentConfig config;
+    std::vector<ExperimentVariant> variants;
+    double cash;
+
+    ExperimentSample runOnce(const ExperimentSetup& setup) {
+        Profiler profiler;
+        // Unavailable counters are reported once, and the remaining runs go without them.
+        if (config.hardwareCounters && !profiler.enableHardwareCounters())
+            config.hardwareCounters = false;
+        PipelineConfig pipelineConfig = setup.pipeline;
+        pipelineConfig.archiveSource = &archive;
+        pipelineConfig.printReport = false;
+
+        TradingEngine tradingEngine(profiler);
+        RiskManager riskManager(symbols, RiskLimits(), profiler);
+        TradeAnalytics analytics(symbols, cash);
+        ConflationCache conflationCache(symbols, setup.pipeline.sharding.conflationPolicy, profiler);
+        Controller controller(tradingEngine, riskManager, analytics, conflationCache, cash, setup.lookbackPeriod,
+                              symbols, dates, pipelineConfig, profiler);
+        controller.runTradingFramework();
+
+        const PipelineRunStats& stats = controller.lastRunStats();
+        ExperimentSample sample;
+        sample.wallSeconds = stats.wallSeconds;
+        sample.ticks = stats.ticksPublished;
+        sample.trades = stats.tradesPersisted;
+        sample.ticksPerSecond = stats.wallSeconds > 0.0 ? stats.ticksPublished / stats.wallSeconds : 0.0;
+        const LatencyHistogram& decisions = profiler.latencyHistogram("Tick To Decision");
+        if (decisions.count()) {
+            sample.decisionP50Ns = static_cast<double>(decisions.percentile(50));
+            sample.decisionP99Ns = static_cast<double>(decisions.percentile(99));
+        }
+        sample.componentSeconds = profiler.componentTotalTimes();
+        if (profiler.hardwareCountersEnabled()) {
+            for (const auto& component : sample.componentSeconds) {
+                ComponentCounters counters = profiler.componentCounters(component.first);
+                if (counters.scopes)
+                    sample.componentCounters[component.first] = counters.totals;
+            }
+        }
+        for (const StageStats& stage : stats.stages)
+            sample.componentSeconds["Stage " + stage.name] = stage.busySeconds;
+        return sample;
+    }
+
+    // Samples for which field returns NaN, such as latencies of runs without decisions, are left out.
+    template <typename Field>
+    static SampleSummary summarizeField(const ExperimentVariant& variant, Field field) {
+        std::vector<double> values;
+        for (const ExperimentSample& sample : variant.samples) {
+            double value = field(sample);
+            if (!std::isnan(value))
+                values.push_back(value);
+        }
+        return summarize(values);
+    }
+
+    static std::string formatSummary(const SampleSummary& summary, int precision) {
+        if (summary.count == 0)
+            return "n/a";
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(precision) << summary.mean << " ± " << summary.halfWidth;
+        return out.str();
+    }
+
+    static std::string formatDelta(const SampleSummary& summary, const SampleSummary& baseline) {
+        if (summary.count == 0 || baseline.count == 0 || baseline.mean == 0.0)
+            return "";
+        std::ostringstream out;
+        out << std::showpos << std::fixed << std::setprecision(1) << 100.0 * (summary.mean - baseline.mean) / baseline.mean
+            << "%" << (significantlyDifferent(summary, baseline) ? "*" : "");
+        return out.str();
+    }
+
+public:
+    /**
+     * @brief Constructor for the ExperimentHarness class.
+     *
+     * @param archive The tick archive whose days form the workload.
+     * @param base The pipeline configuration the variants are applied to.
+     * @param config The repetitions and output of the experiment.
+     * @param cash The initial cash of every run.
+     */
+    ExperimentHarness(const TickArchiveReader& archive, const ExperimentSetup& base, const ExperimentConfig& config,
+                      double cash = 1000000.0)
+        : archive(archive),
+          symbols(archive.symbols()),
+          dates(archive.tradingDates()),
+          base(base),
+          config(config),
+          cash(cash) {}
+
+    /**
+     * @brief Builds the variant matrix from selections of the form dimension=option[,option...].
+     *
+     * Without selections the matrix holds the base configuration alone. Options are combined
+     * in their declared order whatever order they are listed in, so the first variant, the
+     * baseline, takes the earliest declared option selected in every dimension. Combinations in
+     * which a selected option changes nothing, such as window=soa with several shards, are left
+     * out of the matrix, so the report never shows a delta for a variant that is not one.
+     * @return False, after printing why, if a selection is invalid, every combination was left
+     *         out, or the baseline was.
+     */
+    bool select(const std::vector<std::string>& selections) {
+        const std::vector<ExperimentDimension> dimensions = experimentDimensions();
+        variants.assign(1, ExperimentVariant{"", base, {}});
+        std::vector<std::vector<const ExperimentOption*>> applied(1);
+        std::vector<std::string> selected;
+
+        for (const std::string& selection : selections) {
+            size_t equals = selection.find('=');
+            std::string dimensionName = selection.substr(0, equals);
+            auto dimension = std::find_if(dimensions.begin(), dimensions.end(),
+                                          [&](const ExperimentDimension& d) { return d.name == dimensionName; });
+            if (equals == std::string::npos || dimension == dimensions.end()
+                || std::find(selected.begin(), selected.end(), dimensionName) != selected.end()) {
+                std::cerr << "Invalid experiment selection: " << selection << std::endl;
+                printDimensions();
+                return false;
+            }
+            selected.push_back(dimensionName);
+
+            std::vector<const ExperimentOption*> options;
+            std::stringstream optionList(selection.substr(equals + 1));
+            std::string optionName;
+            while (std::getline(optionList, optionName, ',')) {
+                auto option = std::find_if(dimension->options.begin(), dimension->options.end(),
+                                           [&](const ExperimentOption& o) { return o.name == optionName; });
+                if (option == dimension->options.end()) {
+                    std::cerr << "Unknown option " << optionName << " of " << dimensionName << std::endl;
+                    printDimensions();
+                    return false;
+                }
+                options.push_back(&*option);
+            }
+            if (options.empty()) {
+                std::cerr << "No options selected for " << dimensionName << std::endl;
+                return false;
+            }
+            // Declared order, so the first variant, the baseline, takes each dimension's earliest option.
+            std::sort(options.begin(), options.end());
+            options.erase(std::unique(options.begin(), options.end()), options.end());
+
+            std::vector<ExperimentVariant> product;
+            std::vector<std::vector<const ExperimentOption*>> productApplied;
+            for (size_t i = 0; i < variants.size(); i++) {
+                for (const ExperimentOption* option : options) {
+                    ExperimentVariant extended = variants[i];
+                    extended.name += (extended.name.empty() ? "" : " ") + dimensionName + "=" + option->name;
+                    option->apply(extended.setup);
+                    product.push_back(std::move(extended));
+                    productApplied.push_back(applied[i]);
+                    productApplied.back().push_back(option);
+                }
+            }
+            variants = std::move(product);
+            applied = std::move(productApplied);
+        }
+
+        const std::string baselineName = variants[0].name;
+        std::vector<ExperimentVariant> effective;
+        for (size_t i = 0; i < variants.size(); i++) {
+            std::string reason;
+            for (const ExperimentOption* option : applied[i]) {
+                if (option->inertIn && !(reason = option->inertIn(variants[i].setup)).empty()) {
+                    std::cerr << "Leaving out " << variants[i].name << ": " << option->name << " has no effect, "
+                              << reason << std::endl;
+                    break;
+                }
+            }
+            if (reason.empty())
+                effective.push_back(std::move(variants[i]));
+        }
+        variants = std::move(effective);
+        if (variants.empty()) {
+            std::cerr << "No selected combination changes the pipeline" << std::endl;
+            return false;
+        }
+        if (variants[0].name != baselineName) {
+            std::cerr << "The baseline " << baselineName << " was left out, so there is nothing to compare against; "
+                      << "select options that have an effect in it" << std::endl;
+            return false;
+        }
+        if (variants.size() == 1 && variants[0].name.empty())
+            variants[0].name = "base";
+        return true;
+    }
+
+    /**
+     * @brief Prints every dimension with its options, baseline first.
+     */
+    static void printDimensions() {
+        std::cout << "Experiment dimensions (first option is the baseline):" << std::endl;
+        for (const ExperimentDimension& dimension : experimentDimensions()) {
+            std::cout << "  " << dimension.name << "=";
+            for (size_t i = 0; i < dimension.options.size(); i++)
+                std::cout << (i ? "," : "") << dimension.options[i].name;
+            std::cout << "  " << dimension.description << std::endl;
+        }
+    }
+
+    const std::vector<ExperimentVariant>& results() const { return variants; }
+
+    /**
+     * @brief Runs the warmup and measured repetitions of every variant.
+     */
+    void run() {
+        if (variants.empty())
+            select({});
+        std::cout << "Experiment: " << variants.size() << " variants x " << config.repetitions << " repetitions over "
+                  << dates.size() << " days of " << symbols.size() << " symbols" << std::endl;
+        for (size_t round = 0; round < config.warmupRuns; round++) {
+            for (ExperimentVariant& variant : variants)
+                runOnce(variant.setup);
+        }
+        for (size_t repetition = 0; repetition < config.repetitions; repetition++) {
+            for (ExperimentVariant& variant : variants) {
+                variant.samples.push_back(runOnce(variant.setup));
+                const ExperimentSample& sample = variant.samples.back();
+                std::cout << "  [" << repetition + 1 << "/" << config.repetitions << "] " << variant.name << ": "
+                          << std::fixed << std::setprecision(3) << sample.wallSeconds << "s, "
+                          << std::setprecision(0) << sample.ticksPerSecond << " ticks/s" << std::endl;
+            }
+        }
+        if (!config.csvPath.empty())
+            writeCsv(config.csvPath);
+    }
+
+    /**
+     * @brief Prints the comparison of every variant against the baseline.
+     *
+     * A '*' marks a difference from the baseline that is significant at the 95% level.
+     */
+    void printReport() const {
+        if (variants.empty() || variants[0].samples.empty())
+            return;
+        const ExperimentVariant& baseline = variants[0];
+        auto throughput = [](const ExperimentSample& s) { return s.ticksPerSecond; };
+        auto p50 = [](const ExperimentSample& s) { return s.decisionP50Ns > 0.0 ? s.decisionP50Ns / 1000.0 : NAN; };
+        auto p99 = [](const ExperimentSample& s) { return s.decisionP99Ns > 0.0 ? s.decisionP99Ns / 1000.0 : NAN; };
+
+        std::cout << "\nExperiment results (mean ± 95% CI over " << baseline.samples.size()
+                  << " runs; * = significant vs baseline):" << std::endl;
+        std::cout << std::left << std::setw(40) << "Variant" << std::setw(26) << "Ticks/s" << std::setw(10) << "Delta"
+                  << std::setw(22) << "Decision p50 (us)" << std::setw(10) << "Delta"
+                  << std::setw(22) << "Decision p99 (us)" << "Delta" << std::endl;
+        const SampleSummary baseThroughput = summarizeField(baseline, throughput);
+        const SampleSummary baseP50 = summarizeField(baseline, p50);
+        const SampleSummary baseP99 = summarizeField(baseline, p99);
+        for (const ExperimentVariant& variant : variants) {
+            const SampleSummary variantThroughput = summarizeField(variant, throughput);
+            const SampleSummary variantP50 = summarizeField(variant, p50);
+            const SampleSummary variantP99 = summarizeField(variant, p99);
+            const bool isBaseline = &variant == &baseline;
+            std::cout << std::left << std::setw(40) << variant.name
+                      << std::setw(26) << formatSummary(variantThroughput, 0)
+                      << std::setw(10) << (isBaseline ? "" : formatDelta(variantThroughput, baseThroughput))
+                      << std::setw(22) << formatSummary(variantP50, 1)
+                      << std::setw(10) << (isBaseline ? "" : formatDelta(variantP50, baseP50))
+                      << std::setw(22) << formatSummary(variantP99, 1)
+                      << (isBaseline ? "" : formatDelta(variantP99, baseP99)) << std::endl;
+        }
+
+        // Components ordered by the baseline's share of the run, so the costliest come first.
+        std::map<std::string, double> baselineSeconds;
+        for (const ExperimentVariant& variant : variants) {
+            for (const ExperimentSample& sample : variant.samples) {
+                for (const auto& component : sample.componentSeconds)
+                    baselineSeconds.emplace(component.first, 0.0);
+            }
+        }
+        for (const ExperimentSample& sample : baseline.samples) {
+            for (const auto& component : sample.componentSeconds)
+                baselineSeconds[component.first] += component.second;
+        }
+        std::vector<std::pair<std::string, double>> components(baselineSeconds.begin(), baselineSeconds.end());
+        std::stable_sort(components.begin(), components.end(),
+                         [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        std::cout << "\nComponent breakdown (ns per published tick, mean ± 95% CI):" << std::endl;
+        for (const ExperimentVariant& variant : variants) {
+            std::cout << variant.name << std::endl;
+            for (const auto& component : components) {
+                const std::string& name = component.first;
+                auto perTick = [&name](const ExperimentSample& s) {
+                    auto it = s.componentSeconds.find(name);
+                    return it == s.componentSeconds.end() || s.ticks == 0 ? 0.0 : it->second * 1e9 / s.ticks;
+                };
+                const SampleSummary summary = summarizeField(variant, perTick);
+                const SampleSummary baselineSummary = summarizeField(baseline, perTick);
+                // Components below the printed precision in both runs are noise.
+                if (summary.mean < 0.05 && baselineSummary.mean < 0.05)
+                    continue;
+                std::cout << "  " << std::left << std::setw(36) << name << std::setw(24) << formatSummary(summary, 1)
+                          << (&variant == &baseline ? "" : formatDelta(summary, baselineSummary)) << std::endl;
+            }
+        }
+
+        if (!config.hardwareCounters)
+            return;
+        const PerfCounter reported[] = {PerfCounter::Cycles, PerfCounter::Instructions, PerfCounter::LLCMisses,
+                                        PerfCounter::BranchMisses, PerfCounter::ContextSwitches, PerfCounter::PageFaults};
+        std::cout << "\nHardware counters (per published tick, mean ± 95% CI):" << std::endl;
+        for (const ExperimentVariant& variant : variants) {
+            std::cout << variant.name << std::endl;
+            for (const auto& component : components) {
+                const std::string& name = component.first;
+                std::ostringstream line;
+                for (PerfCounter counter : reported) {
+                    // Runs in which the counter was not scheduled are left out rather than counted as zero.
+                    auto perTick = [&name, counter](const ExperimentSample& s) {
+                        auto it = s.componentCounters.find(name);
+                        if (it == s.componentCounters.end() || !it->second.available(counter) || s.ticks == 0)
+                            return static_cast<double>(NAN);
+                        return static_cast<double>(it->second[counter]) / s.ticks;
+                    };
+                    const SampleSummary summary = summarizeField(variant, perTick);
+                    if (summary.count)
+                        line << "  " << perfCounterName(counter) << "=" << formatSummary(summary, 3);
+                }
+                if (!line.str().empty())
+                    std::cout << "  " << std::left << std::setw(36) << name << line.str() << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Writes one CSV row per measured run.
+     */
+    bool writeCsv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Failed to open " << path << std::endl;
+            return false;
+        }
+        out << "variant,repetition,wall_seconds,ticks,trades,ticks_per_second,decision_p50_ns,decision_p99_ns\n";
+        for (const ExperimentVariant& variant : variants) {
+            for (size_t i = 0; i < variant.samples.size(); i++) {
+                const ExperimentSample& sample = variant.samples[i];
+                out << '"' << variant.name << "\"," << i << ',' << sample.wallSeconds << ',' << sample.ticks << ','
+                    << sample.trades << ',' << sample.ticksPerSecond << ',' << sample.decisionP50Ns << ','
+                    << sample.decisionP99Ns << '\n';
+            }
+        }
+        return true;
+    }
+};
@@ -1,19 +1,20 @@
+#pragma once
+
 #include <vector>
 #include "../Model/stock_price.h"
 #include "../Model/stock_trade.h"
 /**
- * @brief Calculate the profits and losses and update the holdings after executing trades.
+ * @brief Update the holdings and cash after executing trades.
  * 
- * This class is responsible for calculating the profits and losses and updating the current holdings
- * after executing trades based on the trading strategy.
+ * This class is responsible for updating the current holdings and cash after executing trades
+ * based on the trading strategy. Realized and unrealized P&L are tracked by the TradeAnalytics.
  * 
  * @param trades The vector of StockTrade objects representing the trades executed based on the trading strategy.
  * @param holdings The vector of StockPrice objects representing the current holdings of stocks.
- * @param profitsLosses The reference to a double representing the current profits and losses.
  * @param cash The reference to a double representing the current available cash.
  */
 void updateHoldingsAndCash(const std::vector<StockTrade>& trades, std::unordered_map<std::string, 
-    double>& holdings, double& profitsLosses, double& cash, Profiler& profiler) {
+    double>& holdings, double& cash, Profiler& profiler) {
     profiler.startComponent("Position Calculator");    
     for (const StockTrade& trade : trades) {
         double currentQuantity = 0.0;
@@ -30,7 +31,6 @@ void updateHoldingsAndCash(const std::vector<StockTrade>& trades, std::unordered
         }
 
         cash -= trade.qty * trade.price;
-        profitsLosses += trade.qty * (trade.price - trade.averagePrice);
     }
     profiler.stopComponent("Position Calculator");    
 }
\ No newline at end of file
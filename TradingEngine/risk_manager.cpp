@@ -0,0 +1,171 @@
+#include "risk_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace {
+const char* const kRiskCheckNames[RiskCheckCount] = {
+    "unknown symbol", "order qty", "order notional", "position qty", "position notional",
+    "gross exposure", "insufficient cash", "price band", "symbol throttle", "portfolio throttle"};
+
+int64_t nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+SharedRiskLedger::SharedRiskLedger(double cash, double maxGrossExposure)
+    : cash_(cash), grossExposure_(0.0), maxGrossExposure_(maxGrossExposure) {}
+
+uint32_t SharedRiskLedger::tryReserve(double qty, double price) {
+    // Exposure follows the same signed convention as a gate's local view: sells release it.
+    const double notional = qty * price;
+
+    double gross = grossExposure_.load(std::memory_order_relaxed);
+    do {
+        if (gross + notional > maxGrossExposure_)
+            return 1u << GrossExposure;
+    } while (!grossExposure_.compare_exchange_weak(gross, gross + notional, std::memory_order_relaxed));
+
+    double cash = cash_.load(std::memory_order_relaxed);
+    do {
+        if (notional > cash) {
+            // Hand the exposure back so a rejected order leaves no trace in the ledger.
+            // std::atomic<double> has no fetch_sub before C++20.
+            double reserved = grossExposure_.load(std::memory_order_relaxed);
+            while (!grossExposure_.compare_exchange_weak(reserved, reserved - notional, std::memory_order_relaxed)) {}
+            return 1u << InsufficientCash;
+        }
+    } while (!cash_.compare_exchange_weak(cash, cash - notional, std::memory_order_relaxed));
+    return 0;
+}
+
+RiskManager::RiskManager(const std::vector<std::string>& symbols, const RiskLimits& limits, Profiler& profiler,
+                         SharedRiskLedger* ledger, const std::string& latencyName)
+    : limits_(limits),
+      grossExposure_(0.0),
+      portfolioTokens_(limits.portfolioOrderBurst),
+      portfolioLastRefillNs_(nowNanoseconds()),
+      accepted_(0),
+      ledger_(ledger),
+      latency_(profiler.latencyHistogram(latencyName)) {
+    rejections_.fill(0);
+
+    // The last slot is a sentinel for unknown tickers so the check path never branches on
+    // a missing lookup; its zero limits guarantee rejection.
+    states_.resize(symbols.size() + 1);
+    for (uint32_t i = 0; i < symbols.size(); i++) {
+        symbolIndex_.emplace(symbols[i], i);
+        SymbolState& state = states_[i];
+        state.tokens = limits_.symbolOrderBurst;
+        state.lastRefillNs = portfolioLastRefillNs_;
+        state.maxPositionQty = limits_.maxPositionQty;
+        state.maxPositionNotional = limits_.maxPositionNotional;
+    }
+    states_.back().lastRefillNs = portfolioLastRefillNs_;
+}
+
+void RiskManager::onMarketData(const std::vector<StockPrice>& prices) {
+    for (const StockPrice& price : prices) {
+        auto it = symbolIndex_.find(price.ticker);
+        if (it != symbolIndex_.end())
+            states_[it->second].referencePrice = price.price;
+    }
+}
+
+uint32_t RiskManager::check(SymbolState& state, const StockTrade& order, double availableCash, int64_t nowNs) {
+    const double qty = static_cast<double>(order.qty);
+    const double notional = qty * order.price;
+    const double newPosition = state.position + qty;
+
+    state.tokens = std::min(limits_.symbolOrderBurst,
+                            state.tokens + (nowNs - state.lastRefillNs) * 1e-9 * limits_.symbolOrdersPerSecond);
+    state.lastRefillNs = nowNs;
+    portfolioTokens_ = std::min(limits_.portfolioOrderBurst,
+                                portfolioTokens_ + (nowNs - portfolioLastRefillNs_) * 1e-9 * limits_.portfolioOrdersPerSecond);
+    portfolioLastRefillNs_ = nowNs;
+
+    const double deviation = std::fabs(order.price - state.referencePrice);
+
+    uint32_t mask = 0;
+    mask |= static_cast<uint32_t>(qty > limits_.maxOrderQty) << OrderQty;
+    mask |= static_cast<uint32_t>(notional > limits_.maxOrderNotional) << OrderNotional;
+    mask |= static_cast<uint32_t>(std::fabs(newPosition) > state.maxPositionQty) << PositionQty;
+    mask |= static_cast<uint32_t>(std::fabs(newPosition) * order.price > state.maxPositionNotional) << PositionNotional;
+    mask |= static_cast<uint32_t>(grossExposure_ + notional > limits_.maxGrossExposure) << GrossExposure;
+    mask |= static_cast<uint32_t>(notional > availableCash) << InsufficientCash;
+    mask |= static_cast<uint32_t>(state.referencePrice <= 0.0 || deviation > limits_.maxPriceDeviation * state.referencePrice) << PriceBand;
+    mask |= static_cast<uint32_t>(state.tokens < 1.0) << SymbolThrottle;
+    mask |= static_cast<uint32_t>(portfolioTokens_ < 1.0) << PortfolioThrottle;
+    return mask;
+}
+
+void RiskManager::apply(SymbolState& state, const StockTrade& order, bool accepted) {
+    // Apply the order to the gate's view without branching on the verdict.
+    const double accept = static_cast<double>(accepted);
+    const double qty = static_cast<double>(order.qty);
+    state.position += accept * qty;
+    state.tokens -= accept;
+    portfolioTokens_ -= accept;
+    // Gross exposure is tracked at execution prices; it is not marked to market.
+    grossExposure_ += accept * qty * order.price;
+}
+
+size_t RiskManager::filterOrders(std::vector<StockTrade>& orders, double cash) {
+    const int64_t batchStartNs = nowNanoseconds();
+    // With a shared ledger the cash and gross exposure checks move into the reservation below.
+    double availableCash = ledger_ ? std::numeric_limits<double>::infinity() : cash;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < orders.size(); i++) {
+        auto start = std::chrono::steady_clock::now();
+
+        auto it = symbolIndex_.find(orders[i].ticker);
+        const bool known = it != symbolIndex_.end();
+        SymbolState& state = states_[known ? it->second : states_.size() - 1];
+        uint32_t mask = check(state, orders[i], availableCash, batchStartNs);
+        mask |= static_cast<uint32_t>(!known) << UnknownSymbol;
+        // Only orders that pass every local check may reserve, so the ledger never needs rolling back.
+        if (ledger_ && mask == 0)
+            mask |= ledger_->tryReserve(static_cast<double>(orders[i].qty), orders[i].price);
+
+        const bool accepted = mask == 0;
+        apply(state, orders[i], accepted);
+        availableCash -= accepted * static_cast<double>(orders[i].qty) * orders[i].price;
+        accepted_ += accepted;
+        for (uint32_t c = 0; c < RiskCheckCount; c++)
+            rejections_[c] += (mask >> c) & 1u;
+
+        if (accepted) {
+            if (kept != i)
+                orders[kept] = std::move(orders[i]);
+            ++kept;
+        }
+
+        latency_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    size_t rejected = orders.size() - kept;
+    orders.erase(orders.begin() + kept, orders.end());
+    return rejected;
+}
+
+void RiskManager::addPosition(const std::string& ticker, double quantity, double notional) {
+    auto it = symbolIndex_.find(ticker);
+    if (it == symbolIndex_.end())
+        return;
+    states_[it->second].position += quantity;
+    grossExposure_ += notional;
+}
+
+void RiskManager::printSummary() const {
+    std::cout << "Risk gate accepted orders: " << accepted_ << std::endl;
+    for (uint32_t c = 0; c < RiskCheckCount; c++) {
+        if (rejections_[c])
+            std::cout << "Risk gate rejections (" << kRiskCheckNames[c] << "): " << rejections_[c] << std::endl;
+    }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Model/stock_price.h"
+#include "../Model/stock_trade.h"
+#include "../Profiler/performance_profiler.h"
+
+/**
+ * @struct RiskLimits
+ * @brief Per-symbol and portfolio limits enforced by the RiskManager before an order is persisted.
+ */
+struct RiskLimits {
+    // The order limits admit the strategy's fixed 1,000-share orders at prices up to $1,000 per share.
+    double maxOrderQty = 1000.0;              // Largest single order, in shares
+    double maxOrderNotional = 1000000.0;      // Largest single order, in cash
+    double maxPositionQty = 10000.0;          // Largest resulting position per symbol, in shares
+    double maxPositionNotional = 2000000.0;   // Largest resulting position per symbol, in cash
+    double maxGrossExposure = 2000000.0;      // Largest sum of position notionals across the portfolio
+    double maxPriceDeviation = 0.05;          // Fat-finger band as a fraction of the last market price
+    double symbolOrdersPerSecond = 50.0;      // Token bucket refill rate per symbol
+    double symbolOrderBurst = 10.0;           // Token bucket capacity per symbol
+    double portfolioOrdersPerSecond = 500.0;  // Token bucket refill rate across all symbols
+    double portfolioOrderBurst = 100.0;       // Token bucket capacity across all symbols
+};
+
+/**
+ * @enum RiskCheck
+ * @brief Bit positions of the individual pre-trade checks in a rejection mask.
+ */
+enum RiskCheck : uint32_t {
+    UnknownSymbol = 0,
+    OrderQty,
+    OrderNotional,
+    PositionQty,
+    PositionNotional,
+    GrossExposure,
+    InsufficientCash,
+    PriceBand,
+    SymbolThrottle,
+    PortfolioThrottle,
+    RiskCheckCount
+};
+
+/**
+ * @class SharedRiskLedger
+ * @brief Portfolio-wide cash and gross exposure shared by the risk gates of several shards.
+ *
+ * Everything else the gate checks is per symbol and stays in the shard that owns the symbol;
+ * only these two totals cross symbols. Reservations are compare-and-swap loops on atomics,
+ * so shards never take a lock to commit an order.
+ */
+class SharedRiskLedger {
+private:
+    std::atomic<double> cash_;
+    std::atomic<double> grossExposure_;
+    const double maxGrossExposure_;
+
+public:
+    /**
+     * @brief Constructor to initialize the SharedRiskLedger.
+     * @param cash The cash available to all shards together.
+     * @param maxGrossExposure The portfolio gross exposure limit.
+     */
+    SharedRiskLedger(double cash, double maxGrossExposure);
+
+    /**
+     * @brief Reserves cash and gross exposure for an order, or neither.
+     * @param qty Signed order quantity; sells release cash instead of reserving it.
+     * @param price The order price.
+     * @return 0 if the order was reserved, otherwise the GrossExposure and InsufficientCash rejection bits.
+     */
+    uint32_t tryReserve(double qty, double price);
+
+    double cash() const { return cash_.load(std::memory_order_relaxed); }
+    double grossExposure() const { return grossExposure_.load(std::memory_order_relaxed); }
+};
+
+/**
+ * @class RiskManager
+ * @brief A pre-trade risk gate that sits between the trading strategy and trade persistence.
+ *
+ * Symbols are mapped to dense indices at construction so every check reads a single
+ * cache-line sized state record. Checks are evaluated unconditionally and folded into a
+ * rejection bitmask, and rejected orders are compacted out of the batch in place, so the
+ * gate neither branches per check nor allocates on the critical path.
+ */
+class RiskManager {
+private:
+    struct alignas(64) SymbolState {
+        double position = 0.0;
+        double referencePrice = 0.0;
+        double tokens = 0.0;
+        int64_t lastRefillNs = 0;
+        double maxPositionQty = 0.0;
+        double maxPositionNotional = 0.0;
+    };
+
+    RiskLimits limits_;
+    std::unordered_map<std::string, uint32_t> symbolIndex_;
+    std::vector<SymbolState> states_;
+    double grossExposure_;
+    double portfolioTokens_;
+    int64_t portfolioLastRefillNs_;
+    std::array<uint64_t, RiskCheckCount> rejections_;
+    uint64_t accepted_;
+    SharedRiskLedger* ledger_;
+    LatencyHistogram& latency_;
+
+    uint32_t check(SymbolState& state, const StockTrade& order, double availableCash, int64_t nowNs);
+    void apply(SymbolState& state, const StockTrade& order, bool accepted);
+
+public:
+    /**
+     * @brief Constructor to initialize the RiskManager.
+     * @param symbols The tradable universe; orders for any other ticker are rejected.
+     * @param limits The limits to enforce.
+     * @param profiler The profiler object that receives the per-order check latency.
+     * @param ledger When set, cash and gross exposure are reserved in this ledger shared with
+     *               other gates instead of being tracked by this gate alone.
+     * @param latencyName The profiler histogram the per-order check latency is recorded into.
+     */
+    RiskManager(const std::vector<std::string>& symbols, const RiskLimits& limits, Profiler& profiler,
+                SharedRiskLedger* ledger = nullptr, const std::string& latencyName = "Risk Gate");
+
+    /**
+     * @brief Updates the reference prices used by the fat-finger band check.
+     * @param prices The newest batch of market data.
+     */
+    void onMarketData(const std::vector<StockPrice>& prices);
+
+    /**
+     * @brief Checks every order against the limits and removes the ones that fail.
+     *
+     * Accepted orders are applied to the gate's own view of positions, exposure and
+     * cash as they pass, so several buys in the same batch cannot jointly over-commit
+     * the available cash.
+     *
+     * @param orders[in, out] The orders produced by the strategy; rejected orders are erased.
+     * @param cash The cash available before this batch is executed; ignored when a ledger is shared.
+     * @return The number of orders rejected.
+     */
+    size_t filterOrders(std::vector<StockTrade>& orders, double cash);
+
+    /**
+     * @brief Adds an existing position to the gate's view, e.g. the holdings restored after a restart.
+     * @param ticker The symbol; unknown symbols are ignored.
+     * @param quantity The shares held.
+     * @param notional What the position cost, added to the gross exposure.
+     */
+    void addPosition(const std::string& ticker, double quantity, double notional);
+
+    uint64_t acceptedCount() const { return accepted_; }
+    uint64_t rejectedCount(RiskCheck check) const { return rejections_[check]; }
+
+    /**
+     * @brief Prints accepted and rejected order counts broken down by check.
+     */
+    void printSummary() const;
+};
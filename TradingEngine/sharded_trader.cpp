@@ -0,0 +1,266 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../Model/stock_price.h"
+#include "../Model/stock_trade.h"
+#include "../Model/util.h"
+#include "../Profiler/performance_profiler.h"
+#include "../Pipeline/core_runtime.h"
+#include "../Pipeline/in_process_transport.h"
+#include "data_consumer.cpp"
+#include "trading_engine.h"
+#include "risk_manager.h"
+#include "trade_analytics.h"
+#include "conflation_cache.h"
+#include "position_calculator.cpp"
+
+/**
+ * @enum MarketDataTransport
+ * @brief Where the consumers read the published ticks from.
+ */
+enum class MarketDataTransport {
+    Kafka,     // The broker topic, one partition per shard
+    InProcess  // An InProcessTransport, for benchmarking without a broker
+};
+
+/**
+ * @struct ShardConfig
+ * @brief Shard count, placement and per-shard component settings of the ShardedTrader.
+ */
+struct ShardConfig {
+    size_t shards = 1;
+    int lookbackPeriod = 10;           // Message timestamp filter of the Kafka consumers, in ms; the controller sets its own
+    size_t maxBatch = 4096;            // Ticks taken from Kafka or the in-process transport per poll
+    ConflationPolicy conflationPolicy = ConflationPolicy::ConflateLatest;
+    RiskLimits riskLimits;
+    StageRuntime runtime;              // Shard i runs on runtime.core + i when a core is configured
+    RuntimeConfig runtimeConfig;
+};
+
+/**
+ * @class ShardedTrader
+ * @brief Runs the consume and trade steps on N threads that each own a disjoint set of symbols.
+ *
+ * A symbol belongs to shard symbolPartition(symbol, N), the same hash the publishers route
+ * with, so each shard reads only its own Kafka or in-process partition. Lookback window,
+ * conflation cache, per-symbol risk state, holdings and analytics are private to the shard
+ * and never shared. The only cross-symbol state is portfolio cash and gross exposure, which
+ * the shards' risk gates reserve in one lock-free SharedRiskLedger; the portfolio order rate
+ * limit is divided between the shards. The TradingEngine is stateless and shared.
+ *
+ * The shard threads persist across days. tradeDay() releases every shard for one trading
+ * day and returns once each has read the day's end-of-day marker from its partition.
+ */
+class ShardedTrader {
+public:
+    using TradeSink = std::function<void(std::vector<StockTrade>&&)>;
+
+private:
+    struct Shard {
+        size_t index;
+        std::unique_ptr<KafkaConsumer> consumer; // Null when reading the in-process transport
+        ConflationCache conflationCache;
+        RiskManager riskManager;
+        TradeAnalytics analytics;
+        std::deque<StockPrice> lookbackWindow;
+        std::unordered_map<std::string, double> holdings;
+        uint64_t ticks = 0;
+        std::thread thread;
+
+        // The portfolio order rate is split evenly instead of shared, so throttling stays shard-local.
+        static RiskLimits shardLimits(const ShardConfig& config) {
+            RiskLimits limits = config.riskLimits;
+            const double shards = static_cast<double>(config.shards ? config.shards : 1);
+            limits.portfolioOrdersPerSecond /= shards;
+            limits.portfolioOrderBurst /= shards;
+            return limits;
+        }
+
+        Shard(size_t index, const std::vector<std::string>& symbols, const ShardConfig& config,
+              SharedRiskLedger& ledger, double cash, Profiler& profiler)
+            : index(index),
+              conflationCache(symbols, config.conflationPolicy, profiler,
+                              "Conflation Staleness (shard " + std::to_string(index) + ")"),
+              riskManager(symbols, shardLimits(config), profiler, &ledger,
+                          "Risk Gate (shard " + std::to_string(index) + ")"),
+              analytics(symbols, cash) {}
+    };
+
+    TradingEngine& tradingEngine;
+    ShardConfig config;
+    InProcessTransport* transport;
+    TradeSink sink;
+    Profiler& profiler;
+    SharedRiskLedger ledger;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::mutex dayMutex;
+    std::condition_variable dayChanged;
+    uint64_t dayGeneration = 0;
+    size_t shardsTrading = 0;
+    bool stopping = false;
+
+    void evaluate(Shard& shard, const std::vector<StockPrice>& newData) {
+        const size_t kept = std::min(shard.lookbackWindow.size(), newData.size());
+        shard.lookbackWindow.erase(shard.lookbackWindow.begin(), shard.lookbackWindow.end() - kept);
+        shard.lookbackWindow.insert(shard.lookbackWindow.end(), newData.begin(), newData.end());
+        shard.riskManager.onMarketData(newData);
+        for (const StockPrice& price : newData)
+            shard.analytics.onPrice(price);
+        for (const TickSummary& summary : shard.conflationCache.summaries())
+            shard.analytics.onSummary(summary);
+
+        // The strategy sizes orders against the pool's cash; the ledger settles them.
+        double cash = ledger.cash();
+        std::vector<StockTrade> trades = tradingEngine.executeTradingStrategy(shard.lookbackWindow, cash, shard.holdings);
+        shard.riskManager.filterOrders(trades, cash);
+
+        updateHoldingsAndCash(trades, shard.holdings, cash, profiler);
+        for (const StockTrade& trade : trades)
+            shard.analytics.onTrade(trade);
+        shard.analytics.sample(newData.back().time);
+
+        if (!trades.empty())
+            sink(std::move(trades));
+    }
+
+    void tradeOneDay(Shard& shard) {
+        std::vector<StockPrice> ticks;
+        std::vector<StockPrice> newData;
+        bool endOfDay = false;
+        while (!endOfDay) {
+            if (transport) {
+                ticks.clear();
+                endOfDay = transport->consume(shard.index, ticks, config.maxBatch, config.runtime.waitStrategy);
+            } else {
+                ticks = shard.consumer->consumeMessages(config.lookbackPeriod, config.maxBatch);
+                endOfDay = shard.consumer->endOfDayReached();
+            }
+            shard.ticks += ticks.size();
+            // A full poll means the partition still holds more ticks.
+            shard.conflationCache.onTicks(ticks, ticks.size() >= config.maxBatch);
+            shard.conflationCache.drain(newData);
+            if (!newData.empty())
+                evaluate(shard, newData);
+        }
+        if (shard.consumer)
+            shard.consumer->startNextDay();
+        shard.lookbackWindow.clear();
+    }
+
+    void run(Shard& shard) {
+        enterStageRuntime("Shard", config.runtime, config.runtimeConfig, shard.index);
+
+        uint64_t tradedGeneration = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(dayMutex);
+                dayChanged.wait(lock, [&] { return stopping || dayGeneration != tradedGeneration; });
+                if (dayGeneration == tradedGeneration)
+                    return;
+                tradedGeneration = dayGeneration;
+            }
+
+            tradeOneDay(shard);
+
+            std::lock_guard<std::mutex> lock(dayMutex);
+            if (--shardsTrading == 0)
+                dayChanged.notify_all();
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor to initialize the ShardedTrader and start its shard threads.
+     * @param tradingEngine The stateless strategy shared by every shard.
+     * @param symbols The tradable universe, split across the shards by symbol hash.
+     * @param cash The cash shared by all shards through the risk ledger.
+     * @param config The shard count, placement and per-shard settings.
+     * @param transport The in-process transport to read, or nullptr to read Kafka partition i in shard i.
+     * @param sink Receives each batch of accepted trades; called concurrently from the shard threads.
+     * @param profiler The profiler object to be used for performance measurement.
+     */
+    ShardedTrader(TradingEngine& tradingEngine, const std::vector<std::string>& symbols, double cash,
+                  const ShardConfig& config, InProcessTransport* transport, TradeSink sink, Profiler& profiler)
+        : tradingEngine(tradingEngine),
+          config(config),
+          transport(transport),
+          sink(std::move(sink)),
+          profiler(profiler),
+          ledger(cash, config.riskLimits.maxGrossExposure) {
+        const size_t shardCount = config.shards ? config.shards : 1;
+        std::vector<std::vector<std::string>> shardSymbols(shardCount);
+        for (const std::string& symbol : symbols)
+            shardSymbols[symbolPartition(symbol, static_cast<uint32_t>(shardCount))].push_back(symbol);
+
+        for (size_t i = 0; i < shardCount; i++) {
+            shards.push_back(std::make_unique<Shard>(i, shardSymbols[i], config, ledger, cash, profiler));
+            if (!transport) {
+                shards.back()->consumer = std::make_unique<KafkaConsumer>(profiler, static_cast<int32_t>(i));
+                shards.back()->consumer->setWaitStrategy(config.runtime.waitStrategy);
+            }
+        }
+        for (std::unique_ptr<Shard>& shard : shards)
+            shard->thread = std::thread(&ShardedTrader::run, this, std::ref(*shard));
+    }
+
+    /**
+     * @brief Stops and joins the shard threads.
+     */
+    ~ShardedTrader() {
+        {
+            std::lock_guard<std::mutex> lock(dayMutex);
+            stopping = true;
+        }
+        dayChanged.notify_all();
+        for (std::unique_ptr<Shard>& shard : shards) {
+            if (shard->thread.joinable())
+                shard->thread.join();
+        }
+    }
+
+    size_t shardCount() const { return shards.size(); }
+
+    /**
+     * @brief Trades one day on every shard and waits until all of them reached its end-of-day marker.
+     */
+    void tradeDay() {
+        std::unique_lock<std::mutex> lock(dayMutex);
+        shardsTrading = shards.size();
+        ++dayGeneration;
+        dayChanged.notify_all();
+        dayChanged.wait(lock, [&] { return shardsTrading == 0; });
+    }
+
+    /**
+     * @brief Returns the analytics of all shards merged into one portfolio view.
+     */
+    AnalyticsSnapshot snapshot() const {
+        std::vector<AnalyticsSnapshot> snapshots;
+        for (const std::unique_ptr<Shard>& shard : shards)
+            snapshots.push_back(shard->analytics.snapshot());
+        return TradeAnalytics::merge(snapshots);
+    }
+
+    /**
+     * @brief Prints the ticks each shard processed, the ledger totals and every shard's risk and conflation counts.
+     */
+    void printSummary() const {
+        std::cout << "Shared ledger cash: " << ledger.cash() << std::endl;
+        std::cout << "Shared ledger gross exposure: " << ledger.grossExposure() << std::endl;
+        for (const std::unique_ptr<Shard>& shard : shards) {
+            std::cout << "Shard " << shard->index << ": " << shard->ticks << " ticks" << std::endl;
+            shard->riskManager.printSummary();
+            shard->conflationCache.printSummary();
+        }
+    }
+};
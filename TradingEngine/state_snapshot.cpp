@@ -0,0 +1,454 @@
+#include "state_snapshot.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+const char kMagic[8] = {'L', 'L', 'T', 'F', 'S', 'N', 'A', 'P'};
+const uint64_t kPageSize = 4096;
+const uint64_t kInitialSlotCapacity = 64 * 1024;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t activeSlot;
+    uint64_t slotCapacity;
+};
+
+struct SlotHeader {
+    uint64_t generation;   // 0 marks a slot that was never written
+    uint64_t payloadSize;
+    uint64_t checksum;
+};
+
+uint64_t checksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t roundUpToPage(uint64_t bytes) {
+    return (bytes + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+class Encoder {
+private:
+    std::vector<char>& out_;
+
+public:
+    explicit Encoder(std::vector<char>& out) : out_(out) {}
+
+    template <typename T>
+    void put(T value) {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        out_.insert(out_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void putString(const std::string& value) {
+        put<uint32_t>(static_cast<uint32_t>(value.size()));
+        out_.insert(out_.end(), value.begin(), value.end());
+    }
+};
+
+class Decoder {
+private:
+    const char* cursor_;
+    const char* end_;
+    bool ok_;
+
+public:
+    Decoder(const char* data, size_t size) : cursor_(data), end_(data + size), ok_(true) {}
+
+    bool ok() const { return ok_; }
+
+    template <typename T>
+    T get() {
+        T value{};
+        if (static_cast<size_t>(end_ - cursor_) < sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        std::memcpy(&value, cursor_, sizeof(T));
+        cursor_ += sizeof(T);
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t size = get<uint32_t>();
+        if (!ok_ || static_cast<size_t>(end_ - cursor_) < size) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string value(cursor_, size);
+        cursor_ += size;
+        return value;
+    }
+};
+
+void encode(const ControllerState& state, std::vector<char>& out) {
+    Encoder encoder(out);
+    encoder.putString(state.date);
+    encoder.put<uint8_t>(state.dayComplete);
+    encoder.put<int64_t>(state.consumerOffset);
+    encoder.put<int64_t>(state.dayStartOffset);
+    encoder.put<uint64_t>(state.tradeSequence);
+    encoder.put<double>(state.cash);
+    encoder.put<uint64_t>(state.holdings.size());
+    for (const auto& holding : state.holdings) {
+        encoder.putString(holding.first);
+        encoder.put<double>(holding.second);
+    }
+    encoder.put<uint64_t>(state.lookbackWindow.size());
+    for (const StockPrice& price : state.lookbackWindow) {
+        encoder.putString(price.ticker);
+        encoder.putString(price.time);
+        encoder.put<double>(price.price);
+    }
+
+    const AnalyticsState& analytics = state.analytics;
+    for (double value : {analytics.cash, analytics.realizedPnL, analytics.unrealizedPnL, analytics.grossExposure,
+                         analytics.netExposure, analytics.totalTurnover, analytics.peakEquity, analytics.maxDrawdown,
+                         analytics.lastEquity})
+        encoder.put<double>(value);
+    encoder.put<uint64_t>(analytics.totalTrades);
+    encoder.put<uint64_t>(analytics.samples);
+    encoder.put<uint64_t>(analytics.returns.size());
+    for (double value : analytics.returns)
+        encoder.put<double>(value);
+    encoder.put<uint64_t>(analytics.symbols.size());
+    for (const SymbolMetrics& metrics : analytics.symbols) {
+        encoder.putString(metrics.ticker);
+        encoder.put<uint64_t>(metrics.tradeCount);
+        encoder.put<uint64_t>(metrics.marketTicks);
+        for (double value : {metrics.sharesTraded, metrics.turnover, metrics.position, metrics.averageCost,
+                             metrics.lastPrice, metrics.realizedPnL, metrics.unrealizedPnL, metrics.exposure,
+                             metrics.sessionHigh, metrics.sessionLow})
+            encoder.put<double>(value);
+    }
+}
+
+bool decode(const char* data, size_t size, ControllerState& state) {
+    Decoder decoder(data, size);
+    ControllerState decoded;
+    decoded.date = decoder.getString();
+    decoded.dayComplete = decoder.get<uint8_t>() != 0;
+    decoded.consumerOffset = decoder.get<int64_t>();
+    decoded.dayStartOffset = decoder.get<int64_t>();
+    decoded.tradeSequence = decoder.get<uint64_t>();
+    decoded.cash = decoder.get<double>();
+
+    uint64_t holdings = decoder.get<uint64_t>();
+    for (uint64_t i = 0; i < holdings && decoder.ok(); i++) {
+        std::string ticker = decoder.getString();
+        double quantity = decoder.get<double>();
+        decoded.holdings.emplace_back(std::move(ticker), quantity);
+    }
+    uint64_t window = decoder.get<uint64_t>();
+    for (uint64_t i = 0; i < window && decoder.ok(); i++) {
+        std::string ticker = decoder.getString();
+        std::string time = decoder.getString();
+        double price = decoder.get<double>();
+        decoded.lookbackWindow.emplace_back(ticker, time, price);
+    }
+
+    AnalyticsState& analytics = decoded.analytics;
+    for (double* value : {&analytics.cash, &analytics.realizedPnL, &analytics.unrealizedPnL, &analytics.grossExposure,
+                          &analytics.netExposure, &analytics.totalTurnover, &analytics.peakEquity,
+                          &analytics.maxDrawdown, &analytics.lastEquity})
+        *value = decoder.get<double>();
+    analytics.totalTrades = decoder.get<uint64_t>();
+    analytics.samples = decoder.get<uint64_t>();
+    uint64_t returns = decoder.get<uint64_t>();
+    for (uint64_t i = 0; i < returns && decoder.ok(); i++)
+        analytics.returns.push_back(decoder.get<double>());
+    uint64_t symbols = decoder.get<uint64_t>();
+    for (uint64_t i = 0; i < symbols && decoder.ok(); i++) {
+        SymbolMetrics metrics;
+        metrics.ticker = decoder.getString();
+        metrics.tradeCount = decoder.get<uint64_t>();
+        metrics.marketTicks = decoder.get<uint64_t>();
+        for (double* value : {&metrics.sharesTraded, &metrics.turnover, &metrics.position, &metrics.averageCost,
+                              &metrics.lastPrice, &metrics.realizedPnL, &metrics.unrealizedPnL, &metrics.exposure,
+                              &metrics.sessionHigh, &metrics.sessionLow})
+            *value = decoder.get<double>();
+        analytics.symbols.push_back(std::move(metrics));
+    }
+
+    if (!decoder.ok())
+        return false;
+    state = std::move(decoded);
+    return true;
+}
+}
+
+StateSnapshotFile::StateSnapshotFile(const std::string& path)
+    : path_(path), fd_(-1), map_(nullptr), mapSize_(0), slotCapacity_(0) {}
+
+StateSnapshotFile::~StateSnapshotFile() {
+    unmap();
+}
+
+void StateSnapshotFile::unmap() {
+    if (map_)
+        munmap(map_, mapSize_);
+    if (fd_ >= 0)
+        close(fd_);
+    map_ = nullptr;
+    fd_ = -1;
+    mapSize_ = 0;
+    slotCapacity_ = 0;
+}
+
+bool StateSnapshotFile::map(uint64_t slotCapacity, bool create) {
+    unmap();
+    fd_ = open(path_.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644);
+    if (fd_ < 0)
+        return false;
+
+    if (create) {
+        mapSize_ = kPageSize + 2 * slotCapacity;
+        if (ftruncate(fd_, static_cast<off_t>(mapSize_)) != 0) {
+            unmap();
+            return false;
+        }
+    } else {
+        FileHeader header;
+        if (pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+            || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion
+            || header.slotCapacity % kPageSize != 0 || header.slotCapacity < sizeof(SlotHeader)) {
+            unmap();
+            return false;
+        }
+        slotCapacity = header.slotCapacity;
+        mapSize_ = kPageSize + 2 * slotCapacity;
+        off_t fileSize = lseek(fd_, 0, SEEK_END);
+        if (fileSize < static_cast<off_t>(mapSize_)) {
+            unmap();
+            return false;
+        }
+    }
+
+    void* map = mmap(nullptr, mapSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        map_ = nullptr;
+        unmap();
+        return false;
+    }
+    map_ = static_cast<char*>(map);
+    slotCapacity_ = slotCapacity;
+
+    if (create) {
+        // Slot 1 starts active but empty, so the first write goes to slot 0.
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.activeSlot = 1;
+        header.slotCapacity = slotCapacity;
+        std::memcpy(map_, &header, sizeof(header));
+    }
+    return true;
+}
+
+bool StateSnapshotFile::readSlot(int slot, ControllerState& state, uint64_t& generation) const {
+    const char* base = map_ + kPageSize + slot * slotCapacity_;
+    SlotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (header.generation == 0 || header.payloadSize > slotCapacity_ - sizeof(SlotHeader))
+        return false;
+
+    const char* payload = base + sizeof(SlotHeader);
+    if (checksum(payload, header.payloadSize) != header.checksum)
+        return false;
+    if (!decode(payload, header.payloadSize, state))
+        return false;
+    generation = header.generation;
+    return true;
+}
+
+bool StateSnapshotFile::load(ControllerState& state) {
+    if (!map_ && !map(0, false))
+        return false;
+
+    FileHeader header;
+    std::memcpy(&header, map_, sizeof(header));
+    const int active = header.activeSlot & 1;
+    uint64_t generation = 0;
+    if (readSlot(active, state, generation))
+        return true;
+    std::cerr << "Snapshot slot " << active << " of " << path_ << " is invalid, trying the previous one" << std::endl;
+    return readSlot(1 - active, state, generation);
+}
+
+bool StateSnapshotFile::write(const ControllerState& state) {
+    std::vector<char> payload;
+    encode(state, payload);
+    const uint64_t needed = sizeof(SlotHeader) + payload.size();
+
+    if (!map_ && !map(0, false) && !map(std::max(kInitialSlotCapacity, roundUpToPage(needed * 2)), true)) {
+        std::cerr << "Failed to create snapshot " << path_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, map_, sizeof(header));
+    SlotHeader active;
+    std::memcpy(&active, map_ + kPageSize + (header.activeSlot & 1) * slotCapacity_, sizeof(active));
+
+    // A grown snapshot is built completely in a new file and only then swapped in with rename(),
+    // which is atomic, so the old snapshot stays readable until the new one is complete and synced.
+    const bool growing = needed > slotCapacity_;
+    const std::string finalPath = path_;
+    if (growing) {
+        path_ = finalPath + ".tmp";
+        if (!map(roundUpToPage(needed * 2), true)) {
+            path_ = finalPath;
+            std::cerr << "Failed to grow snapshot " << path_ << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        std::memcpy(&header, map_, sizeof(header));
+    }
+
+    const uint32_t target = 1 - (header.activeSlot & 1);
+    char* base = map_ + kPageSize + target * slotCapacity_;
+    SlotHeader slot{active.generation + 1, payload.size(), checksum(payload.data(), payload.size())};
+    std::memcpy(base + sizeof(SlotHeader), payload.data(), payload.size());
+    std::memcpy(base, &slot, sizeof(slot));
+    header.activeSlot = target;
+    bool synced = msync(base, roundUpToPage(needed), MS_SYNC) == 0;
+    if (synced) {
+        std::memcpy(map_, &header, sizeof(header));
+        synced = msync(map_, kPageSize, MS_SYNC) == 0;
+    }
+    if (!growing)
+        return synced;
+
+    path_ = finalPath;
+    if (!synced || std::rename((finalPath + ".tmp").c_str(), finalPath.c_str()) != 0) {
+        std::cerr << "Failed to replace snapshot " << path_ << ": " << std::strerror(errno) << std::endl;
+        unmap();
+        return false;
+    }
+    // Persist the rename itself, so a crash cannot bring back the old, smaller file.
+    size_t slash = finalPath.rfind('/');
+    std::string directory = slash == std::string::npos ? "." : finalPath.substr(0, slash + 1);
+    int directoryFd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd >= 0) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+    return true;
+}
+
+Checkpointer::Checkpointer(const std::string& path, std::chrono::milliseconds interval, uint64_t persistedTrades)
+    : file_(path),
+      interval_(interval),
+      lastOffer_(std::chrono::steady_clock::now()),
+      hasPending_(false),
+      persisted_(persistedTrades),
+      persistenceStopped_(false),
+      writing_(false),
+      stopping_(false),
+      written_(0),
+      dropped_(0) {
+    writer_ = std::thread(&Checkpointer::run, this);
+}
+
+Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    pendingChanged_.notify_all();
+    writer_.join();
+}
+
+void Checkpointer::offer(ControllerState&& state) {
+    lastOffer_ = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (persistenceStopped_)
+            return;
+        unpersisted_.push_back(std::move(state));
+        promote();
+    }
+    pendingChanged_.notify_all();
+}
+
+void Checkpointer::persisted(uint64_t tradeSequence) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (tradeSequence <= persisted_)
+            return;
+        persisted_ = tradeSequence;
+        promote();
+    }
+    pendingChanged_.notify_all();
+}
+
+void Checkpointer::stopPersistence() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        persistenceStopped_ = true;
+        dropped_ += unpersisted_.size();
+        unpersisted_.clear();
+    }
+    pendingChanged_.notify_all();
+}
+
+void Checkpointer::promote() {
+    // States are offered in trade order, so the ones whose trades are all persisted form a prefix.
+    while (!unpersisted_.empty() && unpersisted_.front().tradeSequence <= persisted_) {
+        dropped_ += hasPending_;
+        pending_ = std::move(unpersisted_.front());
+        hasPending_ = true;
+        unpersisted_.pop_front();
+    }
+}
+
+void Checkpointer::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    pendingChanged_.wait(lock, [&] { return unpersisted_.empty() && !hasPending_ && !writing_; });
+}
+
+uint64_t Checkpointer::writtenCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return written_;
+}
+
+uint64_t Checkpointer::droppedCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+void Checkpointer::run() {
+    ControllerState state;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pendingChanged_.wait(lock, [&] { return stopping_ || hasPending_; });
+            if (!hasPending_)
+                return;
+            state = std::move(pending_);
+            hasPending_ = false;
+            writing_ = true;
+        }
+
+        bool ok = file_.write(state);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            written_ += ok;
+            writing_ = false;
+        }
+        pendingChanged_.notify_all();
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../Model/stock_price.h"
+#include "trade_analytics.h"
+
+/**
+ * @struct ControllerState
+ * @brief Everything the trade stage needs to continue a run where it stopped.
+ *
+ * The state is consistent at a batch boundary: it reflects every tick before
+ * consumerOffset and none after it.
+ */
+struct ControllerState {
+    std::string date;            // Trading day the state belongs to
+    bool dayComplete = false;    // True once the day's end-of-day marker was processed
+    int64_t consumerOffset = 0;  // Kafka offset of the first message not yet reflected
+    int64_t dayStartOffset = 0;  // Kafka offset of the day's first message; consumerOffset once the day is complete
+    uint64_t tradeSequence = 0;  // Trades emitted so far; every one is persisted before the state is written
+    double cash = 0.0;
+    std::vector<std::pair<std::string, double>> holdings;
+    std::vector<StockPrice> lookbackWindow;
+    AnalyticsState analytics;    // The final report comes from the analytics, so they resume too
+};
+
+/**
+ * @class StateSnapshotFile
+ * @brief A versioned, memory-mapped, double-buffered binary snapshot of the ControllerState.
+ *
+ * The file holds a header page followed by two slots. A write serializes into the slot that
+ * is not active, syncs it, and only then flips the active slot in the header, so a crash
+ * during a write leaves the previous snapshot intact. Each slot carries a generation and a
+ * checksum, and load() falls back to the other slot if the active one fails validation.
+ */
+class StateSnapshotFile {
+private:
+    std::string path_;
+    int fd_;
+    char* map_;
+    size_t mapSize_;
+    uint64_t slotCapacity_;
+
+    bool map(uint64_t slotCapacity, bool create);
+    void unmap();
+    bool readSlot(int slot, ControllerState& state, uint64_t& generation) const;
+
+public:
+    static const uint32_t kVersion = 4;
+
+    /**
+     * @brief Constructor to initialize the StateSnapshotFile. Nothing is opened until load() or write().
+     * @param path The snapshot file.
+     */
+    explicit StateSnapshotFile(const std::string& path);
+    ~StateSnapshotFile();
+
+    StateSnapshotFile(const StateSnapshotFile&) = delete;
+    StateSnapshotFile& operator=(const StateSnapshotFile&) = delete;
+
+    /**
+     * @brief Maps the snapshot file and decodes the newest valid slot.
+     * @param state[out] The restored state.
+     * @return False if there is no file, it has another version, or neither slot is valid.
+     */
+    bool load(ControllerState& state);
+
+    /**
+     * @brief Writes the state to the inactive slot and makes it the active one.
+     *
+     * The slots are grown, by rewriting the file under a temporary name and renaming it,
+     * when the state no longer fits.
+     *
+     * @return False if the file could not be created, mapped or synced.
+     */
+    bool write(const ControllerState& state);
+};
+
+/**
+ * @class Checkpointer
+ * @brief Writes ControllerState snapshots on a background thread.
+ *
+ * The trade stage hands over a copy of its state with offer(); the copy waits until the
+ * persist stage reports every trade it reflects as persisted, so a snapshot never counts a
+ * trade that is missing from the trade store. It is then moved into a single pending slot
+ * under a mutex that the writer only holds to take it, so the trade stage never waits on
+ * serialization or disk. If a newer state becomes ready before the previous one was written,
+ * the older one is dropped.
+ */
+class Checkpointer {
+private:
+    StateSnapshotFile file_;
+    std::chrono::milliseconds interval_;
+    std::chrono::steady_clock::time_point lastOffer_;
+
+    std::mutex mutex_;
+    std::condition_variable pendingChanged_;
+    std::deque<ControllerState> unpersisted_; // Offered states whose trades are not all persisted yet
+    ControllerState pending_;
+    bool hasPending_;
+    uint64_t persisted_;
+    bool persistenceStopped_;
+    bool writing_;
+    bool stopping_;
+    uint64_t written_;
+    uint64_t dropped_;
+    std::thread writer_;
+
+    void run();
+    void promote();
+
+public:
+    /**
+     * @brief Constructor to initialize the Checkpointer and start its writer thread.
+     * @param path The snapshot file.
+     * @param interval The minimum time between periodic checkpoints.
+     * @param persistedTrades The trade sequence already persisted, e.g. that of the restored snapshot.
+     */
+    Checkpointer(const std::string& path, std::chrono::milliseconds interval, uint64_t persistedTrades = 0);
+
+    /**
+     * @brief Writes any pending state and stops the writer thread.
+     *
+     * States still waiting for their trades to be persisted are discarded.
+     */
+    ~Checkpointer();
+
+    /**
+     * @brief Whether the checkpoint interval has elapsed since the last offer.
+     *
+     * Lets the trade stage skip building a state copy when no checkpoint is due.
+     */
+    bool due() const { return std::chrono::steady_clock::now() - lastOffer_ >= interval_; }
+
+    /**
+     * @brief Hands a state to the writer thread without waiting for it to be written.
+     */
+    void offer(ControllerState&& state);
+
+    /**
+     * @brief Releases the offered states whose tradeSequence is at most the given one for writing.
+     * @param tradeSequence The number of trades persisted so far, counted like ControllerState::tradeSequence.
+     */
+    void persisted(uint64_t tradeSequence);
+
+    /**
+     * @brief Reports that no more trades will be persisted, e.g. because the persist stage failed.
+     *
+     * The states still waiting are discarded and flush() stops waiting for them.
+     */
+    void stopPersistence();
+
+    /**
+     * @brief Blocks until every offered state has been written or discarded.
+     */
+    void flush();
+
+    uint64_t writtenCount();
+    uint64_t droppedCount();
+};
@@ -0,0 +1,256 @@
+#include "trade_analytics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+TradeAnalytics::TradeAnalytics(const std::vector<std::string>& symbols, double initialCash,
+                               const AnalyticsConfig& config)
+    : config_(config),
+      initialCash_(initialCash),
+      cash_(initialCash),
+      realizedPnL_(0.0),
+      unrealizedPnL_(0.0),
+      grossExposure_(0.0),
+      netExposure_(0.0),
+      totalTrades_(0),
+      totalTurnover_(0.0),
+      peakEquity_(initialCash),
+      maxDrawdown_(0.0),
+      lastEquity_(initialCash),
+      returns_(std::max<size_t>(config.sharpeWindow, 2), 0.0),
+      returnsHead_(0),
+      returnsCount_(0),
+      returnsSum_(0.0),
+      returnsSumSquares_(0.0),
+      samples_(0) {
+    symbols_.reserve(symbols.size());
+    for (const std::string& symbol : symbols)
+        metricsFor(symbol);
+}
+
+SymbolMetrics& TradeAnalytics::metricsFor(const std::string& ticker) {
+    auto it = symbolIndex_.find(ticker);
+    if (it != symbolIndex_.end())
+        return symbols_[it->second];
+
+    symbolIndex_.emplace(ticker, symbols_.size());
+    symbols_.push_back(SymbolMetrics());
+    symbols_.back().ticker = ticker;
+    return symbols_.back();
+}
+
+void TradeAnalytics::markToMarket(SymbolMetrics& metrics, double price) {
+    double oldExposure = metrics.exposure;
+    double oldUnrealized = metrics.unrealizedPnL;
+
+    metrics.lastPrice = price;
+    metrics.exposure = metrics.position * price;
+    metrics.unrealizedPnL = metrics.position * (price - metrics.averageCost);
+
+    netExposure_ += metrics.exposure - oldExposure;
+    grossExposure_ += std::fabs(metrics.exposure) - std::fabs(oldExposure);
+    unrealizedPnL_ += metrics.unrealizedPnL - oldUnrealized;
+}
+
+void TradeAnalytics::onTrade(const StockTrade& trade) {
+    SymbolMetrics& metrics = metricsFor(trade.ticker);
+    const double qty = static_cast<double>(trade.qty);
+    const double notional = qty * trade.price;
+
+    ++metrics.tradeCount;
+    ++totalTrades_;
+    metrics.sharesTraded += std::fabs(qty);
+    metrics.turnover += std::fabs(notional);
+    totalTurnover_ += std::fabs(notional);
+    cash_ -= notional;
+
+    const double position = metrics.position;
+    const double newPosition = position + qty;
+    if (newPosition == 0.0 && position == 0.0) {
+        // Zero-quantity fill: nothing to blend or realize.
+    } else if (position == 0.0 || (position > 0.0) == (qty > 0.0)) {
+        // Opening or adding to a position: blend the average cost.
+        metrics.averageCost = (metrics.averageCost * std::fabs(position) + trade.price * std::fabs(qty))
+                              / std::fabs(newPosition);
+    } else {
+        // Reducing, closing or flipping: realize P&L on the closed quantity.
+        double closedQty = std::min(std::fabs(qty), std::fabs(position));
+        double realized = closedQty * (trade.price - metrics.averageCost) * (position > 0.0 ? 1.0 : -1.0);
+        metrics.realizedPnL += realized;
+        realizedPnL_ += realized;
+        if (newPosition == 0.0)
+            metrics.averageCost = 0.0;
+        else if ((newPosition > 0.0) != (position > 0.0))
+            metrics.averageCost = trade.price;
+    }
+    metrics.position = newPosition;
+
+    markToMarket(metrics, trade.price);
+}
+
+void TradeAnalytics::onPrice(const StockPrice& price) {
+    SymbolMetrics& metrics = metricsFor(price.ticker);
+    markToMarket(metrics, price.price);
+    if (metrics.marketTicks++ == 0)
+        metrics.sessionHigh = metrics.sessionLow = price.price;
+    metrics.sessionHigh = std::max(metrics.sessionHigh, price.price);
+    metrics.sessionLow = std::min(metrics.sessionLow, price.price);
+}
+
+void TradeAnalytics::onSummary(const TickSummary& summary) {
+    SymbolMetrics& metrics = metricsFor(summary.ticker);
+    if (metrics.marketTicks == 0) {
+        metrics.sessionHigh = summary.high;
+        metrics.sessionLow = summary.low;
+    }
+    metrics.marketTicks += summary.tickCount - 1;
+    metrics.sessionHigh = std::max(metrics.sessionHigh, summary.high);
+    metrics.sessionLow = std::min(metrics.sessionLow, summary.low);
+}
+
+void TradeAnalytics::sample(const std::string& time) {
+    const double equity = cash_ + netExposure_;
+
+    peakEquity_ = std::max(peakEquity_, equity);
+    maxDrawdown_ = std::max(maxDrawdown_, peakEquity_ - equity);
+
+    const double ret = lastEquity_ != 0.0 ? (equity - lastEquity_) / lastEquity_ : 0.0;
+    lastEquity_ = equity;
+    if (returnsCount_ == returns_.size()) {
+        double evicted = returns_[returnsHead_];
+        returnsSum_ -= evicted;
+        returnsSumSquares_ -= evicted * evicted;
+    } else {
+        ++returnsCount_;
+    }
+    returns_[returnsHead_] = ret;
+    returnsSum_ += ret;
+    returnsSumSquares_ += ret * ret;
+    returnsHead_ = (returnsHead_ + 1) % returns_.size();
+
+    if (samples_++ % std::max<size_t>(config_.curveStride, 1) == 0)
+        pnlCurve_.push_back({time, realizedPnL_ + unrealizedPnL_});
+}
+
+AnalyticsSnapshot TradeAnalytics::snapshot() const {
+    AnalyticsSnapshot snapshot;
+    snapshot.initialCash = initialCash_;
+    snapshot.cash = cash_;
+    snapshot.equity = cash_ + netExposure_;
+    snapshot.realizedPnL = realizedPnL_;
+    snapshot.unrealizedPnL = unrealizedPnL_;
+    snapshot.grossExposure = grossExposure_;
+    snapshot.netExposure = netExposure_;
+    snapshot.maxDrawdown = maxDrawdown_;
+    snapshot.totalTrades = totalTrades_;
+    snapshot.totalTurnover = totalTurnover_;
+    snapshot.symbols = symbols_;
+
+    if (returnsCount_ > 1) {
+        double mean = returnsSum_ / returnsCount_;
+        double variance = std::max(0.0, returnsSumSquares_ / returnsCount_ - mean * mean);
+        snapshot.rollingSharpe = variance > 0.0 ? mean / std::sqrt(variance) : 0.0;
+    }
+    return snapshot;
+}
+
+AnalyticsState TradeAnalytics::state() const {
+    AnalyticsState state;
+    state.cash = cash_;
+    state.realizedPnL = realizedPnL_;
+    state.unrealizedPnL = unrealizedPnL_;
+    state.grossExposure = grossExposure_;
+    state.netExposure = netExposure_;
+    state.totalTrades = totalTrades_;
+    state.totalTurnover = totalTurnover_;
+    state.peakEquity = peakEquity_;
+    state.maxDrawdown = maxDrawdown_;
+    state.lastEquity = lastEquity_;
+    state.samples = samples_;
+    // The oldest return sits at the head once the ring is full, otherwise at index 0.
+    const size_t oldest = returnsCount_ == returns_.size() ? returnsHead_ : 0;
+    for (size_t i = 0; i < returnsCount_; i++)
+        state.returns.push_back(returns_[(oldest + i) % returns_.size()]);
+    state.symbols = symbols_;
+    return state;
+}
+
+void TradeAnalytics::restore(const AnalyticsState& state) {
+    cash_ = state.cash;
+    realizedPnL_ = state.realizedPnL;
+    unrealizedPnL_ = state.unrealizedPnL;
+    grossExposure_ = state.grossExposure;
+    netExposure_ = state.netExposure;
+    totalTrades_ = state.totalTrades;
+    totalTurnover_ = state.totalTurnover;
+    peakEquity_ = state.peakEquity;
+    maxDrawdown_ = state.maxDrawdown;
+    lastEquity_ = state.lastEquity;
+    samples_ = state.samples;
+
+    std::fill(returns_.begin(), returns_.end(), 0.0);
+    returnsHead_ = 0;
+    returnsCount_ = 0;
+    returnsSum_ = 0.0;
+    returnsSumSquares_ = 0.0;
+    const size_t first = state.returns.size() > returns_.size() ? state.returns.size() - returns_.size() : 0;
+    for (size_t i = first; i < state.returns.size(); i++) {
+        const double ret = state.returns[i];
+        returns_[returnsHead_] = ret;
+        returnsSum_ += ret;
+        returnsSumSquares_ += ret * ret;
+        returnsHead_ = (returnsHead_ + 1) % returns_.size();
+        ++returnsCount_;
+    }
+
+    for (const SymbolMetrics& metrics : state.symbols)
+        metricsFor(metrics.ticker) = metrics;
+}
+
+AnalyticsSnapshot TradeAnalytics::merge(const std::vector<AnalyticsSnapshot>& shards) {
+    AnalyticsSnapshot merged;
+    if (shards.empty())
+        return merged;
+
+    merged.initialCash = shards.front().initialCash;
+    merged.cash = merged.initialCash;
+    for (const AnalyticsSnapshot& shard : shards) {
+        merged.cash += shard.cash - shard.initialCash;
+        merged.realizedPnL += shard.realizedPnL;
+        merged.unrealizedPnL += shard.unrealizedPnL;
+        merged.grossExposure += shard.grossExposure;
+        merged.netExposure += shard.netExposure;
+        merged.maxDrawdown = std::max(merged.maxDrawdown, shard.maxDrawdown);
+        merged.totalTrades += shard.totalTrades;
+        merged.totalTurnover += shard.totalTurnover;
+        merged.symbols.insert(merged.symbols.end(), shard.symbols.begin(), shard.symbols.end());
+    }
+    merged.equity = merged.cash + merged.netExposure;
+    return merged;
+}
+
+void TradeAnalytics::printReport(const AnalyticsSnapshot& snapshot) {
+    std::cout << "Initial Cash: " << snapshot.initialCash << std::endl;
+    std::cout << "Final Cash: " << snapshot.cash << std::endl;
+    std::cout << "Change in Cash: " << snapshot.cash - snapshot.initialCash << std::endl;
+    std::cout << "Final Equity: " << snapshot.equity << std::endl;
+    std::cout << "Realized P&L: " << snapshot.realizedPnL << std::endl;
+    std::cout << "Unrealized P&L: " << snapshot.unrealizedPnL << std::endl;
+    std::cout << "Final P&L: " << snapshot.totalPnL() << std::endl;
+    std::cout << "Max Drawdown: " << snapshot.maxDrawdown << std::endl;
+    std::cout << "Rolling Sharpe (per sample): " << snapshot.rollingSharpe << std::endl;
+    std::cout << "Gross Exposure: " << snapshot.grossExposure << std::endl;
+    std::cout << "Net Exposure: " << snapshot.netExposure << std::endl;
+    for (const SymbolMetrics& symbol : snapshot.symbols) {
+        std::cout << symbol.ticker << ": " << symbol.tradeCount << " trades executed"
+                  << ", turnover " << symbol.turnover
+                  << ", fill VWAP " << symbol.fillVwap()
+                  << ", position " << symbol.position
+                  << ", range " << symbol.sessionLow << "-" << symbol.sessionHigh
+                  << " over " << symbol.marketTicks << " ticks"
+                  << ", P&L " << symbol.realizedPnL + symbol.unrealizedPnL << std::endl;
+    }
+    std::cout << "Total trades executed: " << snapshot.totalTrades << std::endl;
+    std::cout << "Total turnover: " << snapshot.totalTurnover << std::endl;
+}
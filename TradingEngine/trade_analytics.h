@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Model/stock_price.h"
+#include "../Model/stock_trade.h"
+#include "conflation_cache.h"
+
+/**
+ * @struct AnalyticsConfig
+ * @brief Window sizes used by TradeAnalytics.
+ */
+struct AnalyticsConfig {
+    size_t sharpeWindow = 1000; // Number of most recent equity samples in the rolling Sharpe ratio
+    size_t curveStride = 100;   // Keep one P&L curve point every curveStride equity samples
+};
+
+/**
+ * @struct SymbolMetrics
+ * @brief Running trade and P&L metrics for one symbol.
+ */
+struct SymbolMetrics {
+    std::string ticker;
+    uint64_t tradeCount = 0;
+    double sharesTraded = 0.0;
+    double turnover = 0.0;        // Sum of |qty * price| over all fills
+    double position = 0.0;
+    double averageCost = 0.0;     // Average cost per share of the open position
+    double lastPrice = 0.0;
+    double realizedPnL = 0.0;
+    double unrealizedPnL = 0.0;
+    double exposure = 0.0;        // position * lastPrice
+    uint64_t marketTicks = 0;     // Price updates seen, including those conflated into OHLC summaries
+    double sessionHigh = 0.0;
+    double sessionLow = 0.0;
+
+    double fillVwap() const { return sharesTraded > 0.0 ? turnover / sharesTraded : 0.0; }
+};
+
+/**
+ * @struct PnLPoint
+ * @brief One point of the portfolio P&L curve.
+ */
+struct PnLPoint {
+    std::string time;
+    double pnl;
+};
+
+/**
+ * @struct AnalyticsSnapshot
+ * @brief A point-in-time copy of the portfolio and per-symbol metrics.
+ */
+struct AnalyticsSnapshot {
+    double initialCash = 0.0;
+    double cash = 0.0;
+    double equity = 0.0;
+    double realizedPnL = 0.0;
+    double unrealizedPnL = 0.0;
+    double grossExposure = 0.0;
+    double netExposure = 0.0;
+    double maxDrawdown = 0.0;
+    double rollingSharpe = 0.0;
+    uint64_t totalTrades = 0;
+    double totalTurnover = 0.0;
+    std::vector<SymbolMetrics> symbols;
+
+    double totalPnL() const { return realizedPnL + unrealizedPnL; }
+};
+
+/**
+ * @struct AnalyticsState
+ * @brief The running totals a TradeAnalytics needs to continue a run after a restart.
+ *
+ * The P&L curve is not included; after a restart it only covers the resumed run.
+ */
+struct AnalyticsState {
+    double cash = 0.0;
+    double realizedPnL = 0.0;
+    double unrealizedPnL = 0.0;
+    double grossExposure = 0.0;
+    double netExposure = 0.0;
+    uint64_t totalTrades = 0;
+    double totalTurnover = 0.0;
+    double peakEquity = 0.0;
+    double maxDrawdown = 0.0;
+    double lastEquity = 0.0;
+    uint64_t samples = 0;
+    std::vector<double> returns;  // The rolling Sharpe window, oldest first
+    std::vector<SymbolMetrics> symbols;
+};
+
+/**
+ * @class TradeAnalytics
+ * @brief Incrementally maintained trade statistics fed by every fill and price update.
+ *
+ * Every event updates the per-symbol record and the portfolio aggregates in O(1), so the
+ * report can be produced at any point of a run without touching the trades database.
+ * The analytics are owned by the thread that feeds them; snapshots must be taken from
+ * that thread.
+ */
+class TradeAnalytics {
+private:
+    AnalyticsConfig config_;
+    std::unordered_map<std::string, size_t> symbolIndex_;
+    std::vector<SymbolMetrics> symbols_;
+
+    double initialCash_;
+    double cash_;
+    double realizedPnL_;
+    double unrealizedPnL_;
+    double grossExposure_;
+    double netExposure_;
+    uint64_t totalTrades_;
+    double totalTurnover_;
+
+    double peakEquity_;
+    double maxDrawdown_;
+    double lastEquity_;
+    std::vector<double> returns_;
+    size_t returnsHead_;
+    size_t returnsCount_;
+    double returnsSum_;
+    double returnsSumSquares_;
+    uint64_t samples_;
+    std::vector<PnLPoint> pnlCurve_;
+
+    SymbolMetrics& metricsFor(const std::string& ticker);
+    void markToMarket(SymbolMetrics& metrics, double price);
+
+public:
+    /**
+     * @brief Constructor to initialize the TradeAnalytics.
+     * @param symbols The symbols to pre-register; unknown symbols are added on first use.
+     * @param initialCash The cash the portfolio starts with.
+     * @param config Window sizes for the rolling metrics.
+     */
+    TradeAnalytics(const std::vector<std::string>& symbols, double initialCash,
+                   const AnalyticsConfig& config = AnalyticsConfig());
+
+    /**
+     * @brief Applies a fill to the symbol's position, cash, turnover and realized P&L.
+     * @param trade The executed trade.
+     */
+    void onTrade(const StockTrade& trade);
+
+    /**
+     * @brief Marks the symbol's open position to the new price.
+     * @param price The price update.
+     */
+    void onPrice(const StockPrice& price);
+
+    /**
+     * @brief Accounts for the ticks conflated into a delivered update.
+     *
+     * The delivered close is passed to onPrice() as usual; the summary adds the ticks it
+     * replaced to the symbol's tick count and their high and low to its session range, which
+     * would otherwise only cover the prices that reached the strategy.
+     *
+     * @param summary The ConflateOHLC summary of the update.
+     */
+    void onSummary(const TickSummary& summary);
+
+    /**
+     * @brief Records an equity sample for the drawdown, rolling Sharpe and P&L curve.
+     *
+     * Call once per processed batch; the Sharpe ratio is computed over the returns between
+     * consecutive samples and is not annualized.
+     *
+     * @param time The market time of the sample.
+     */
+    void sample(const std::string& time);
+
+    /**
+     * @brief Returns a copy of the current portfolio and per-symbol metrics.
+     */
+    AnalyticsSnapshot snapshot() const;
+
+    /**
+     * @brief Returns the running totals for a restart checkpoint.
+     */
+    AnalyticsState state() const;
+
+    /**
+     * @brief Continues from the totals of a checkpoint; the initial cash stays the constructor's.
+     */
+    void restore(const AnalyticsState& state);
+
+    const std::vector<PnLPoint>& pnlCurve() const { return pnlCurve_; }
+
+    /**
+     * @brief Combines the snapshots of shards that traded disjoint symbols from one cash pool.
+     *
+     * Counts, P&L, exposure and cash flows add up exactly. Drawdown and Sharpe depend on when
+     * each shard's equity moved, which the snapshots do not record: the merged drawdown is the
+     * worst single shard's and the rolling Sharpe is left at zero.
+     *
+     * @param shards One snapshot per shard, each started with the full initial cash.
+     */
+    static AnalyticsSnapshot merge(const std::vector<AnalyticsSnapshot>& shards);
+
+    /**
+     * @brief Prints the portfolio summary and per-symbol breakdown of a snapshot.
+     */
+    static void printReport(const AnalyticsSnapshot& snapshot);
+};
@@ -22,22 +22,27 @@ std::vector<std::string> TradingEngine::movingAverageCrossover(const std::deque<
 }
 
 std::vector<StockTrade> TradingEngine::executeTradingStrategy(const std::deque<StockPrice>& lookbackWindow, double cash,
-                                                              const std::unordered_map<std::string, double>& currentHoldings,
-                                                              double currentProfitsLosses) {
+                                                              const std::unordered_map<std::string, double>& currentHoldings) {
     profiler_.startComponent("TradingEngine");
 
     std::vector<StockTrade> trades;
 
     std::vector<std::string> stocksToBuy = movingAverageCrossover(lookbackWindow);
 
+    // Orders are priced and sized at their own symbol's latest tick, not at whichever symbol ticked last.
+    std::unordered_map<std::string, const StockPrice*> latestPrices;
+    for (const auto& price : lookbackWindow)
+        latestPrices[price.ticker] = &price;
+
     for (const auto& stock : stocksToBuy) {
-        double maxQuantity = cash / lookbackWindow.back().price;
+        const StockPrice& latest = *latestPrices[stock];
+        double maxQuantity = cash / latest.price;
         double quantityToBuy = std::min(maxQuantity, 1000.0);
 
-        double cost = quantityToBuy * lookbackWindow.back().price;
+        double cost = quantityToBuy * latest.price;
         cash -= cost;
 
-        trades.push_back({stock, lookbackWindow.back().time, static_cast<size_t>(quantityToBuy)});
+        trades.push_back({stock, latest.time, static_cast<size_t>(quantityToBuy), latest.price});
     }
 
     profiler_.stopComponent("TradingEngine");
@@ -37,6 +37,5 @@ public:
      * @return Vector of StockTrade representing the trades to make.
      */
     std::vector<StockTrade> executeTradingStrategy(const std::deque<StockPrice>& lookbackWindow, double cash,
-                                                   const std::unordered_map<std::string, double>& currentHoldings,
-                                                   double currentProfitsLosses);
+                                                   const std::unordered_map<std::string, double>& currentHoldings);
 };
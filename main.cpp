@@ -1,18 +1,116 @@
 #include "TradingEngine/controller.cpp"
 #include "TradingEngine/trading_engine.h"
+#include "TradingEngine/risk_manager.h"
+#include "TradingEngine/trade_analytics.h"
+#include "TradingEngine/conflation_cache.h"
+#include "TradingEngine/cross_sectional.h"
+#include "TradingEngine/experiment_harness.cpp"
 #include "Profiler/performance_profiler.h"
 #include <vector>
 #include <string>
-int main() {
+#include <memory>
+int main(int argc, char* argv[]) {
     
     std::vector<std::string> symbols = {"MSFT", "AMZN", "GOOGL", "META", "NFLX"};
     std::vector<std::string> dates = {"2023-08-02"};
     double cash = 1000000.0;
     int lookbackPeriod = 30000;
     Profiler profiler;
+    PipelineConfig pipelineConfig;
+
+    // --perf-counters, anywhere on the command line: attribute hardware counters to each profiled component.
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--perf-counters")
+            profiler.enableHardwareCounters();
+    }
+
+    // --bench-signals: compare the cross-sectional signal kernels at 500 and 5,000 symbols and exit.
+    if (argc >= 2 && std::string(argv[1]) == "--bench-signals") {
+        bool consistent = benchmarkCrossSectional({500, 5000}, 20000, profiler);
+        return consistent ? 0 : 1;
+    }
+
+    // --archive-bench <path> <symbols> <days>: archive generated bars, report compression and decode speed, and exit.
+    if (argc >= 5 && std::string(argv[1]) == "--archive-bench") {
+        SyntheticMarketConfig syntheticConfig;
+        syntheticConfig.symbolCount = std::stoul(argv[3]);
+        syntheticConfig.tradingDays = std::stoul(argv[4]);
+        SyntheticMarketData syntheticBars(syntheticConfig);
+        syntheticBars.generate(profiler);
+        std::vector<std::vector<StockPrice>> days;
+        for (size_t day = 0; day < syntheticBars.tradingDates().size(); day++)
+            days.push_back(syntheticBars.dayPrices(day));
+        return benchmarkTickArchive(argv[2], syntheticBars.tradingDates(), days) ? 0 : 1;
+    }
+
+    // --experiment <archive> <repetitions> [dimension=option,option ...]: replay a tick archive through the
+    // full pipeline under every combination of the selected options and compare them. Without a
+    // selection, lists the dimensions and measures the base configuration alone.
+    if (argc >= 4 && std::string(argv[1]) == "--experiment") {
+        TickArchiveReader experimentArchive(argv[2]);
+        if (!experimentArchive.valid())
+            return 1;
+        ExperimentSetup baseSetup;
+        baseSetup.lookbackPeriod = lookbackPeriod;
+        baseSetup.pipeline.transport = MarketDataTransport::InProcess;
+        ExperimentConfig experimentConfig;
+        experimentConfig.repetitions = std::stoul(argv[3]);
+        experimentConfig.csvPath = "experiment_runs.csv";
+        // Every run builds its own Profiler, so the flag is passed on instead of applying to the one above.
+        experimentConfig.hardwareCounters = profiler.hardwareCountersEnabled();
+        std::vector<std::string> selections;
+        for (int i = 4; i < argc; i++) {
+            if (std::string(argv[i]) != "--perf-counters")
+                selections.push_back(argv[i]);
+        }
+        if (selections.empty())
+            ExperimentHarness::printDimensions();
+        ExperimentHarness harness(experimentArchive, baseSetup, experimentConfig, cash);
+        if (!harness.select(selections))
+            return 1;
+        harness.run();
+        harness.printReport();
+        return 0;
+    }
+
+    // --synthetic <symbols> <days> [archive]: trade generated data instead of querying Alpha Vantage,
+    // optionally recording the interpolated ticks to a tick archive.
+    std::unique_ptr<SyntheticMarketData> syntheticData;
+    std::unique_ptr<TickArchiveWriter> archiveWriter;
+    if (argc >= 4 && std::string(argv[1]) == "--synthetic") {
+        SyntheticMarketConfig syntheticConfig;
+        syntheticConfig.symbolCount = std::stoul(argv[2]);
+        syntheticConfig.tradingDays = std::stoul(argv[3]);
+        syntheticData = std::make_unique<SyntheticMarketData>(syntheticConfig);
+        syntheticData->generate(profiler);
+        symbols = syntheticData->symbols();
+        dates = syntheticData->tradingDates();
+        pipelineConfig.syntheticSource = syntheticData.get();
+        if (argc >= 5) {
+            archiveWriter = std::make_unique<TickArchiveWriter>(argv[4]);
+            pipelineConfig.archiveSink = archiveWriter.get();
+        }
+    }
+
+    // --archive <path>: replay the days of a tick archive instead of querying Alpha Vantage.
+    std::unique_ptr<TickArchiveReader> archiveReader;
+    if (argc >= 3 && std::string(argv[1]) == "--archive") {
+        archiveReader = std::make_unique<TickArchiveReader>(argv[2]);
+        if (!archiveReader->valid())
+            return 1;
+        symbols = archiveReader->symbols();
+        dates = archiveReader->tradingDates();
+        pipelineConfig.archiveSource = archiveReader.get();
+    }
+
     TradingEngine tradingEngine(profiler);
-    Controller controller(tradingEngine, cash, lookbackPeriod, symbols, dates, profiler);
+    RiskManager riskManager(symbols, RiskLimits(), profiler);
+    TradeAnalytics analytics(symbols, cash);
+    ConflationCache conflationCache(symbols, ConflationPolicy::ConflateLatest, profiler);
+    Controller controller(tradingEngine, riskManager, analytics, conflationCache, cash, lookbackPeriod, symbols, dates, pipelineConfig, profiler);
     controller.runTradingFramework();
+    if (archiveWriter)
+        archiveWriter->finish();
     profiler.printComponentTimes();
     return 0;
 }